@@ -1,22 +1,33 @@
 #pragma once
 
 #include <cstdlib>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <mutex>
+#include <utility>
+#include <cstdint>
 #include "allocator_interface.h"
 
+using std::exception;
+
 /**
  * @brief The simplest allocator
  *
- * The simplest allocator based on standard malloc/free functions
+ * The simplest stateless allocator based on standard malloc/free functions
  */
-class simple_allocator_t : public allocator_interface_t {
+class simple_allocator_t {
 public:
+  static constexpr bool threadSafe = true;   ///< malloc/free may be called from any thread
+
   /**
    * A method that allocates a block of size 'size'
    *
    * @param[in] size number of bytes to allocate
    * @return pointer to allocated memory
    */
-  void* alloc(size_t size) override {
+  void* alloc(size_t size) {
     return malloc(size);
   }
 
@@ -25,7 +36,927 @@ public:
    *
    * @param[in] data pointer to block
    */
-  void dealloc(void* data) override {
+  void dealloc(void* data) {
+    free(data);
+  }
+
+  /**
+   * A method that allocates a block of size 'size' aligned to 'align'
+   *
+   * @param[in] size number of bytes to allocate
+   * @param[in] align alignment of the block (a power of two)
+   * @return pointer to allocated memory (nullptr if there is no memory)
+   */
+  void* alloc(size_t size, size_t align) {
+    return ::operator new(size, std::align_val_t(align), std::nothrow);
+  }
+
+  /**
+   * Dealocation a block allocated with alignment
+   *
+   * @param[in] data pointer to block
+   * @param[in] align alignment the block was allocated with
+   */
+  void dealloc(void* data, size_t align) {
+    ::operator delete(data, std::align_val_t(align));
+  }
+};
+
+/**
+ * @brief Malloc slab source
+ *
+ * Slab source of the pool allocator (see basic_pool_allocator_t) that takes slabs from malloc/free
+ */
+class malloc_slab_source_t {
+public:
+  static constexpr char const* outOfMemory = "Pool is out of memory";   ///< message of the exception thrown if there is no memory for a slab
+
+  /**
+   * Allocate slab
+   * @param[in] size number of bytes to allocate
+   * @return pointer to allocated memory (nullptr if there is no memory)
+   */
+  void* AllocSlab(size_t size) noexcept {
+    return malloc(size);
+  }
+
+  /**
+   * Free slab
+   * @param[in] data pointer to slab
+   * @param[in] size number of bytes passed to AllocSlab
+   */
+  void FreeSlab(void* data, size_t size) noexcept {
+    (void)size;
     free(data);
   }
+};
+
+/**
+ * @brief Fixed-size pool allocator
+ *
+ * Allocator that carves slabs into equal slots and recycles freed slots through an intrusive free list,
+ * so in steady state allocation and deallocation never reach the system allocator.
+ * The slot size is taken from the constructor or from the first request
+ * @tparam slabSource type of slab source providing AllocSlab(size), FreeSlab(data, size) and 'outOfMemory' message
+ * (malloc_slab_source_t or numa_slab_source_t)
+ * @warning memory is returned to the system only when the allocator is destroyed
+ * @see fixed_slot_allocator
+ */
+template <typename slabSource = malloc_slab_source_t>
+class basic_pool_allocator_t : private slabSource {
+private:
+  /**
+   * @brief Free slot struct
+   *
+   * Header written into a free slot to link it into the free list
+   */
+  struct free_slot_t {
+    free_slot_t* next;        ///< pointer to next free slot (nullptr if the slot is the last one)
+  };
+
+  /**
+   * @brief Slab header struct
+   *
+   * Header placed at the beginning of every slab, slots follow it
+   */
+  struct alignas(std::max_align_t) slab_t {
+    slab_t* next;             ///< pointer to next slab (nullptr if the slab is the last one)
+    size_t bytes;             ///< size of the slab in bytes
+  };
+
+  size_t slotSize;            ///< size of one slot in bytes (0 until it is known)
+  size_t slotsPerSlab;        ///< number of slots carved from one slab
+  slab_t* slabs;              ///< list of all allocated slabs
+  free_slot_t* freeList;      ///< list of free slots
+  size_t freeSlots;           ///< number of slots in the free list
+
+  /**
+   * Set the slot size if it is not set yet
+   * @param[in] size number of bytes in one request
+   * @exception "Requested size exceeds pool slot size" if size does not fit into a slot
+   */
+  void SetSlotSize(size_t size) {
+    if (slotSize == 0) {
+      size_t align = alignof(free_slot_t);
+
+      slotSize = size < sizeof(free_slot_t) ? sizeof(free_slot_t) : (size + align - 1) / align * align;
+    }
+    else if (size > slotSize)
+      throw exception("Requested size exceeds pool slot size");
+  }
+
+  /**
+   * Allocate a new slab from the slab source and put its slots into the free list
+   * @param[in] count number of slots in the slab
+   * @exception slabSource::outOfMemory if the slab source fails
+   */
+  void AddSlab(size_t count) {
+    size_t bytes = sizeof(slab_t) + count * slotSize;
+    slab_t* slab = (slab_t*)slabSource::AllocSlab(bytes);
+
+    if (slab == nullptr)
+      throw exception(slabSource::outOfMemory);
+
+    slab->next = slabs;
+    slab->bytes = bytes;
+    slabs = slab;
+
+    char* slot = (char*)(slab + 1) + (count - 1) * slotSize;
+
+    for (size_t i = 0; i < count; i++, slot -= slotSize) {
+      free_slot_t* freeSlot = (free_slot_t*)slot;
+
+      freeSlot->next = freeList;
+      freeList = freeSlot;
+    }
+
+    freeSlots += count;
+  }
+
+  /**
+   * Free all slabs
+   */
+  void ReleaseSlabs() noexcept {
+    while (slabs) {
+      slab_t* tmp = slabs;
+
+      slabs = slabs->next;
+      slabSource::FreeSlab(tmp, tmp->bytes);
+    }
+
+    freeList = nullptr;
+    freeSlots = 0;
+  }
+protected:
+  /**
+   * Get slab source method
+   * @return const reference on the slab source
+   */
+  slabSource const& SlabSource() const noexcept {
+    return *this;
+  }
+public:
+  static constexpr size_t alignment = alignof(free_slot_t);   ///< slots are aligned for a pointer only
+  static constexpr bool fixedSlot = true;                      ///< serves requests of one size only (the slot size)
+
+  /**
+   * Pool allocator constructor
+   * @param[in] slotSize size of one slot in bytes (0 to take it from the first request)
+   * @param[in] slotsPerSlab number of slots carved from one slab
+   * @param[in] source slab source
+   */
+  explicit basic_pool_allocator_t(size_t slotSize = 0, size_t slotsPerSlab = 64, slabSource const& source = slabSource()) :
+    slabSource(source), slotSize(0), slotsPerSlab(slotsPerSlab > 0 ? slotsPerSlab : 1), slabs(nullptr), freeList(nullptr), freeSlots(0) {
+    if (slotSize)
+      SetSlotSize(slotSize);
+  }
+
+  /**
+   * Copy constructor (creates an empty pool with the same settings and slab source)
+   * @param[in] pool const reference on pool to copy settings from
+   */
+  basic_pool_allocator_t(basic_pool_allocator_t const& pool) :
+    slabSource(pool.SlabSource()), slotSize(pool.slotSize), slotsPerSlab(pool.slotsPerSlab), slabs(nullptr), freeList(nullptr), freeSlots(0) {}
+
+  /**
+   * Move constructor
+   * @param[in] pool rvalue reference on pool to move
+   */
+  basic_pool_allocator_t(basic_pool_allocator_t&& pool) noexcept :
+    slabSource(pool.SlabSource()), slotSize(pool.slotSize), slotsPerSlab(pool.slotsPerSlab), slabs(pool.slabs), freeList(pool.freeList), freeSlots(pool.freeSlots) {
+    pool.slabs = nullptr;
+    pool.freeList = nullptr;
+    pool.freeSlots = 0;
+  }
+
+  /**
+   * Copy operator= (keeps own slabs and slab source, copies settings only if the slot size is not set yet)
+   * @param[in] pool const reference on pool to copy settings from
+   * @return reference to pool
+   */
+  basic_pool_allocator_t& operator=(basic_pool_allocator_t const& pool) {
+    if (slotSize == 0)
+      slotSize = pool.slotSize;
+
+    return *this;
+  }
+
+  /**
+   * Move operator=
+   * @param[in] pool rvalue reference on pool to move
+   * @warning all blocks allocated from this pool must be already deallocated
+   * @return reference to pool
+   */
+  basic_pool_allocator_t& operator=(basic_pool_allocator_t&& pool) noexcept {
+    if (this != &pool) {
+      ReleaseSlabs();
+
+      static_cast<slabSource&>(*this) = pool.SlabSource();
+      slotSize = pool.slotSize;
+      slotsPerSlab = pool.slotsPerSlab;
+      slabs = pool.slabs;
+      freeList = pool.freeList;
+      freeSlots = pool.freeSlots;
+
+      pool.slabs = nullptr;
+      pool.freeList = nullptr;
+      pool.freeSlots = 0;
+    }
+
+    return *this;
+  }
+
+  /**
+   * A method that allocates a block of size 'size'
+   *
+   * @param[in] size number of bytes to allocate
+   * @return pointer to allocated memory
+   * @exception "Requested size exceeds pool slot size" if size does not fit into a slot
+   * @exception slabSource::outOfMemory if the slab source fails
+   */
+  void* alloc(size_t size) {
+    SetSlotSize(size);
+
+    if (freeList == nullptr)
+      AddSlab(slotsPerSlab);
+
+    free_slot_t* slot = freeList;
+
+    freeList = slot->next;
+    freeSlots--;
+
+    return slot;
+  }
+
+  /**
+   * Dealocation a block by pointer
+   *
+   * @param[in] data pointer to block
+   */
+  void dealloc(void* data) {
+    if (data == nullptr)
+      return;
+
+    free_slot_t* slot = (free_slot_t*)data;
+
+    slot->next = freeList;
+    freeList = slot;
+    freeSlots++;
+  }
+
+  /**
+   * Pre-reserve slots so that next 'count' allocations do not reach the system allocator
+   *
+   * @param[in] count number of slots to have in the free list
+   * @param[in] size number of bytes in one request (0 to use the already known slot size)
+   * @exception "Pool slot size is unknown" if size is 0 and the slot size is not set yet
+   */
+  void Reserve(size_t count, size_t size = 0) {
+    if (size)
+      SetSlotSize(size);
+    else if (slotSize == 0)
+      throw exception("Pool slot size is unknown");
+
+    if (count > freeSlots)
+      AddSlab(count - freeSlots);
+  }
+
+  /**
+   * Get slot size method
+   * @return size of one slot in bytes (0 if it is not set yet)
+   */
+  size_t SlotSize() const noexcept {
+    return slotSize;
+  }
+
+  /**
+   * Get number of free slots method
+   * @return number of slots that can be allocated without reaching the system allocator
+   */
+  size_t FreeSlots() const noexcept {
+    return freeSlots;
+  }
+
+  /**
+   * Comparison operator == (blocks can be deallocated only by the pool they were allocated from)
+   * @param[in] pool pool we want to compare with
+   * @return true if it is the same pool, false otherwise
+   */
+  bool operator==(basic_pool_allocator_t const& pool) const noexcept {
+    return this == &pool;
+  }
+
+  /**
+   * Pool allocator destructor
+   */
+  ~basic_pool_allocator_t() {
+    ReleaseSlabs();
+  }
+};
+
+/**
+ * Pool allocator taking slabs from malloc
+ */
+using pool_allocator_t = basic_pool_allocator_t<malloc_slab_source_t>;
+
+/**
+ * @brief Arena (monotonic) allocator
+ *
+ * Allocator that bumps a pointer through large chunks and never frees single blocks.
+ * Copies of the allocator share one arena, so many short-lived deques can use it
+ * and the whole memory is reclaimed in one step by Reset or when the last copy is destroyed
+ * @warning blocks allocated from the arena become invalid after Reset
+ */
+class arena_allocator_t {
+private:
+  /**
+   * @brief Arena chunk struct
+   *
+   * Header placed at the beginning of every chunk, allocated memory follows it
+   */
+  struct alignas(std::max_align_t) chunk_t {
+    chunk_t* next;            ///< pointer to previously allocated chunk (nullptr if the chunk is the first one)
+    size_t capacity;          ///< number of bytes available after header
+  };
+
+  /**
+   * @brief Arena struct
+   *
+   * Shared state of all copies of the allocator
+   */
+  struct arena_t {
+    chunk_t* chunks = nullptr;  ///< list of chunks (the current one is first)
+    char* cur = nullptr;        ///< first free byte in the current chunk
+    char* end = nullptr;        ///< end of the current chunk
+    size_t chunkSize;           ///< capacity of the next chunk in bytes
+
+    /**
+     * Arena constructor
+     * @param[in] chunkSize capacity of the first chunk in bytes
+     */
+    explicit arena_t(size_t chunkSize) : chunkSize(chunkSize) {}
+
+    /**
+     * Arena destructor
+     */
+    ~arena_t() {
+      while (chunks) {
+        chunk_t* tmp = chunks;
+
+        chunks = chunks->next;
+        free(tmp);
+      }
+    }
+  };
+
+  static constexpr size_t maxChunkSize = 1 << 20;   ///< chunk capacity stops doubling at this size
+
+  std::shared_ptr<arena_t> arena;   ///< shared arena
+  size_t initialChunkSize;          ///< capacity of the first chunk in bytes
+
+  /**
+   * Allocate a new chunk and make it current
+   * @param[in] size number of bytes which must fit into the chunk
+   * @exception "Arena is out of memory" if the system allocator fails
+   */
+  void AddChunk(size_t size) {
+    size_t capacity = size > arena->chunkSize ? size : arena->chunkSize;
+    chunk_t* chunk = (chunk_t*)malloc(sizeof(chunk_t) + capacity);
+
+    if (chunk == nullptr)
+      throw exception("Arena is out of memory");
+
+    chunk->next = arena->chunks;
+    chunk->capacity = capacity;
+    arena->chunks = chunk;
+    arena->cur = (char*)(chunk + 1);
+    arena->end = arena->cur + capacity;
+
+    if (arena->chunkSize < maxChunkSize)
+      arena->chunkSize *= 2;
+  }
+public:
+  static constexpr bool bulkRelease = true;   ///< dealloc does nothing, memory is released by Reset
+
+  /**
+   * Arena allocator constructor
+   * @param[in] chunkSize capacity of the first chunk in bytes
+   */
+  explicit arena_allocator_t(size_t chunkSize = 4096) :
+    arena(std::make_shared<arena_t>(chunkSize > 0 ? chunkSize : 1)), initialChunkSize(chunkSize > 0 ? chunkSize : 1) {}
+
+  /**
+   * A method that allocates a block of size 'size'
+   *
+   * @param[in] size number of bytes to allocate
+   * @return pointer to allocated memory
+   */
+  void* alloc(size_t size) {
+    if (!arena)   // moved-from allocator gets a new arena
+      arena = std::make_shared<arena_t>(initialChunkSize);
+
+    size_t align = alignof(std::max_align_t);
+
+    size = (size + align - 1) / align * align;
+
+    if ((size_t)(arena->end - arena->cur) < size)
+      AddChunk(size);
+
+    void* data = arena->cur;
+
+    arena->cur += size;
+
+    return data;
+  }
+
+  /**
+   * Dealocation a block by pointer (does nothing, memory is released by Reset)
+   *
+   * @param[in] data pointer to block
+   */
+  void dealloc(void* data) noexcept {
+    (void)data;
+  }
+
+  /**
+   * Release all memory allocated from the arena at once (the largest chunk is kept for reuse)
+   */
+  void Reset() noexcept {
+    if (!arena || arena->chunks == nullptr)
+      return;
+
+    chunk_t* largest = arena->chunks;
+
+    for (chunk_t* chunk = arena->chunks; chunk; chunk = chunk->next)
+      if (chunk->capacity > largest->capacity)
+        largest = chunk;
+
+    while (arena->chunks) {
+      chunk_t* tmp = arena->chunks;
+
+      arena->chunks = arena->chunks->next;
+      if (tmp != largest)
+        free(tmp);
+    }
+
+    largest->next = nullptr;
+    arena->chunks = largest;
+    arena->cur = (char*)(largest + 1);
+    arena->end = arena->cur + largest->capacity;
+  }
+
+  /**
+   * Get used memory method
+   * @return number of bytes in the chunks owned by the arena
+   */
+  size_t Capacity() const noexcept {
+    size_t capacity = 0;
+
+    if (arena)
+      for (chunk_t* chunk = arena->chunks; chunk; chunk = chunk->next)
+        capacity += chunk->capacity;
+
+    return capacity;
+  }
+
+  /**
+   * Comparison operator ==
+   * @param[in] allocator allocator we want to compare with
+   * @return true if both allocators share the same arena, false otherwise
+   */
+  bool operator==(arena_allocator_t const& allocator) const noexcept {
+    return this == &allocator || (arena && arena == allocator.arena);
+  }
+};
+
+/**
+ * @brief Thread-caching magazine allocator
+ *
+ * Stateless allocator for multithreaded producer/consumer use: every thread keeps two magazines (short free lists)
+ * of blocks per size class and a process-wide depot exchanges full magazines between threads under a per-class lock,
+ * so a block freed by another thread costs a thread-local push and the depot is reached once per 'magazineSize' calls.
+ * Requests up to 512 bytes are served from 64 KiB slabs whose header tells the size class of a block;
+ * larger requests get their own slab-aligned allocation
+ * @warning memory of size classes is never returned to the system, blocks are only recycled
+ */
+class magazine_allocator_t {
+private:
+  static constexpr size_t classGranularity = 16;                            ///< size step between size classes
+  static constexpr size_t sizeClasses = 32;                                 ///< number of size classes
+  static constexpr size_t maxClassSize = sizeClasses * classGranularity;    ///< largest size served from slabs
+  static constexpr size_t largeClass = sizeClasses;                         ///< size class mark of large allocations
+  static constexpr size_t magazineSize = 64;                                ///< number of blocks in a full magazine
+  static constexpr size_t slabSize = 1 << 16;                               ///< size and alignment of slabs
+
+  /**
+   * @brief Free block struct
+   *
+   * Header written into a free block to link it into a magazine
+   */
+  struct free_block_t {
+    free_block_t* next;       ///< pointer to next block of the magazine (nullptr if the block is the last one)
+    free_block_t* nextFull;   ///< pointer to next full magazine (used in the depot by the first block of a magazine)
+  };
+
+  /**
+   * @brief Slab header struct
+   *
+   * Header placed at the beginning of every slab, blocks follow it
+   */
+  struct alignas(64) slab_t {
+    size_t sizeClass;         ///< size class of blocks in the slab (largeClass for a large allocation)
+  };
+
+  /**
+   * @brief Magazine struct
+   *
+   * Free list of blocks of one size class owned by a thread
+   */
+  struct magazine_t {
+    free_block_t* head = nullptr;   ///< first block
+    size_t count = 0;               ///< number of blocks
+  };
+
+  /**
+   * @brief Depot size class struct
+   *
+   * Shared state of one size class (aligned to a cache line to keep locks of classes apart)
+   */
+  struct alignas(64) depot_class_t {
+    std::mutex lock;                  ///< lock of the size class
+    free_block_t* full = nullptr;     ///< list of full magazines linked by 'nextFull' of their first blocks
+    free_block_t* loose = nullptr;    ///< blocks of partially filled magazines returned by exited threads
+    char* cur = nullptr;              ///< first free byte in the current slab
+    char* end = nullptr;              ///< end of the current slab
+  };
+
+  /**
+   * @brief Thread cache struct
+   *
+   * Magazines of one thread, returned to the depot when the thread exits
+   */
+  struct thread_cache_t {
+    magazine_t loaded[sizeClasses];     ///< magazines blocks are taken from and put to
+    magazine_t previous[sizeClasses];   ///< magazines that are either full or empty
+
+    /**
+     * Thread cache destructor
+     */
+    ~thread_cache_t() {
+      for (size_t i = 0; i < sizeClasses; i++) {
+        ReturnMagazine(i, loaded[i]);
+        ReturnMagazine(i, previous[i]);
+      }
+
+      CacheDestroyed() = true;
+    }
+  };
+
+  /**
+   * Get depot method
+   * @return pointer to the depot size classes (never destroyed, so blocks may be released at any time)
+   */
+  static depot_class_t* Depot() noexcept {
+    static depot_class_t* depot = new depot_class_t[sizeClasses];
+
+    return depot;
+  }
+
+  /**
+   * Get thread cache state method
+   * @return reference on the flag set when the thread cache of the calling thread is destroyed
+   * (blocks released by later thread exit handlers go straight to the depot)
+   */
+  static bool& CacheDestroyed() noexcept {
+    thread_local bool destroyed = false;
+
+    return destroyed;
+  }
+
+  /**
+   * Get thread cache method
+   * @return reference on magazines of the calling thread
+   */
+  static thread_cache_t& Cache() noexcept {
+    thread_local thread_cache_t cache;
+
+    return cache;
+  }
+
+  /**
+   * Get slab of block
+   * @param[in] data pointer to block
+   * @return pointer to slab header
+   */
+  static slab_t* SlabOf(void* data) noexcept {
+    return (slab_t*)((uintptr_t)data & ~(uintptr_t)(slabSize - 1));
+  }
+
+  /**
+   * Return magazine to the depot (full magazines are kept whole, blocks of partial ones are put to the loose list)
+   * @param[in] sizeClass size class of magazine
+   * @param[in] magazine magazine to return (becomes empty)
+   */
+  static void ReturnMagazine(size_t sizeClass, magazine_t& magazine) noexcept {
+    if (magazine.count == 0)
+      return;
+
+    depot_class_t& depot = Depot()[sizeClass];
+    std::lock_guard<std::mutex> lock(depot.lock);
+
+    if (magazine.count == magazineSize) {
+      magazine.head->nextFull = depot.full;
+      depot.full = magazine.head;
+    }
+    else
+      while (magazine.head) {
+        free_block_t* block = magazine.head;
+
+        magazine.head = block->next;
+        block->next = depot.loose;
+        depot.loose = block;
+      }
+
+    magazine.head = nullptr;
+    magazine.count = 0;
+  }
+
+  /**
+   * Fill empty magazine from the depot (full magazines first, then loose blocks, then a slab)
+   * @param[in] sizeClass size class of magazine
+   * @param[in] magazine empty magazine to fill
+   * @exception "Magazine allocator is out of memory" if a new slab cannot be allocated
+   */
+  static void FillMagazine(size_t sizeClass, magazine_t& magazine) {
+    depot_class_t& depot = Depot()[sizeClass];
+    std::lock_guard<std::mutex> lock(depot.lock);
+
+    if (depot.full) {
+      magazine.head = depot.full;
+      magazine.count = magazineSize;
+      depot.full = depot.full->nextFull;
+      return;
+    }
+
+    while (depot.loose && magazine.count < magazineSize) {
+      free_block_t* block = depot.loose;
+
+      depot.loose = block->next;
+      block->next = magazine.head;
+      magazine.head = block;
+      magazine.count++;
+    }
+
+    size_t blockSize = (sizeClass + 1) * classGranularity;
+
+    while (magazine.count < magazineSize) {
+      if ((size_t)(depot.end - depot.cur) < blockSize) {
+        slab_t* slab = (slab_t*)::operator new(slabSize, std::align_val_t(slabSize), std::nothrow);
+
+        if (slab == nullptr) {
+          if (magazine.count)
+            return;
+
+          throw exception("Magazine allocator is out of memory");
+        }
+
+        slab->sizeClass = sizeClass;
+        depot.cur = (char*)(slab + 1);
+        depot.end = (char*)slab + slabSize;
+      }
+
+      free_block_t* block = (free_block_t*)depot.cur;
+
+      depot.cur += blockSize;
+      block->next = magazine.head;
+      magazine.head = block;
+      magazine.count++;
+    }
+  }
+public:
+  static constexpr bool threadSafe = true;              ///< every thread works with its own magazines
+  static constexpr size_t alignment = classGranularity;  ///< blocks are aligned to the size class step
+
+  /**
+   * A method that allocates a block of size 'size'
+   *
+   * @param[in] size number of bytes to allocate
+   * @return pointer to allocated memory
+   * @exception "Magazine allocator is out of memory" if the system allocator fails
+   */
+  void* alloc(size_t size) {
+    if (size > maxClassSize) {
+      if (size > SIZE_MAX - sizeof(slab_t))
+        throw exception("Magazine allocator is out of memory");
+
+      slab_t* slab = (slab_t*)::operator new(sizeof(slab_t) + size, std::align_val_t(slabSize), std::nothrow);
+
+      if (slab == nullptr)
+        throw exception("Magazine allocator is out of memory");
+
+      slab->sizeClass = largeClass;
+
+      return slab + 1;
+    }
+
+    size_t sizeClass = size ? (size - 1) / classGranularity : 0;
+
+    if (CacheDestroyed()) {
+      magazine_t magazine;
+
+      FillMagazine(sizeClass, magazine);
+
+      free_block_t* block = magazine.head;
+
+      magazine.head = block->next;
+      magazine.count--;
+      ReturnMagazine(sizeClass, magazine);
+
+      return block;
+    }
+
+    thread_cache_t& cache = Cache();
+    magazine_t& loaded = cache.loaded[sizeClass];
+
+    if (loaded.count == 0) {
+      if (cache.previous[sizeClass].count)
+        std::swap(loaded, cache.previous[sizeClass]);
+      else
+        FillMagazine(sizeClass, loaded);
+    }
+
+    free_block_t* block = loaded.head;
+
+    loaded.head = block->next;
+    loaded.count--;
+
+    return block;
+  }
+
+  /**
+   * Dealocation a block by pointer (the block may be allocated by any thread)
+   *
+   * @param[in] data pointer to block
+   */
+  void dealloc(void* data) noexcept {
+    if (data == nullptr)
+      return;
+
+    slab_t* slab = SlabOf(data);
+
+    if (slab->sizeClass == largeClass) {
+      ::operator delete((void*)slab, std::align_val_t(slabSize));
+      return;
+    }
+
+    size_t sizeClass = slab->sizeClass;
+    free_block_t* block = (free_block_t*)data;
+
+    if (CacheDestroyed()) {
+      magazine_t magazine;
+
+      block->next = nullptr;
+      magazine.head = block;
+      magazine.count = 1;
+      ReturnMagazine(sizeClass, magazine);
+      return;
+    }
+
+    thread_cache_t& cache = Cache();
+    magazine_t& loaded = cache.loaded[sizeClass];
+
+    if (loaded.count == magazineSize) {
+      magazine_t& previous = cache.previous[sizeClass];
+
+      if (previous.count)
+        ReturnMagazine(sizeClass, previous);
+
+      std::swap(loaded, previous);
+    }
+
+    block->next = loaded.head;
+    loaded.head = block;
+    loaded.count++;
+  }
+
+  /**
+   * Return magazines of the calling thread to the depot (done automatically when the thread exits)
+   */
+  static void FlushThreadCache() noexcept {
+    thread_cache_t& cache = Cache();
+
+    for (size_t i = 0; i < sizeClasses; i++) {
+      ReturnMagazine(i, cache.loaded[i]);
+      ReturnMagazine(i, cache.previous[i]);
+    }
+  }
+};
+
+/**
+ * @brief Allocator adapter
+ *
+ * Implements allocator_interface_t over a statically dispatched allocator,
+ * so it can be used where a runtime-polymorphic allocator is expected
+ * @tparam memoryAllocator the allocator to be wrapped
+ */
+template <deque_allocator memoryAllocator>
+class allocator_adapter_t : public allocator_interface_t {
+private:
+  memoryAllocator allocator;  ///< wrapped allocator
+public:
+  /**
+   * A method that allocates a block of size 'size'
+   *
+   * @param[in] size number of bytes to allocate
+   * @return pointer to allocated memory
+   */
+  void* alloc(size_t size) override {
+    return allocator.alloc(size);
+  }
+
+  /**
+   * Dealocation a block by pointer
+   *
+   * @param[in] data pointer to block
+   */
+  void dealloc(void* data) override {
+    allocator.dealloc(data);
+  }
+
+  /**
+   * Get wrapped allocator method
+   * @return reference on wrapped allocator
+   */
+  memoryAllocator& Allocator() noexcept {
+    return allocator;
+  }
+};
+
+/**
+ * @brief Runtime-polymorphic allocator
+ *
+ * Opt-in allocator that forwards requests to an allocator_interface_t object through virtual calls
+ * (allocator_adapter_t<simple_allocator_t> is used by default)
+ * @warning the allocator_interface_t object must outlive all deques using it
+ */
+class polymorphic_allocator_t {
+private:
+  allocator_interface_t* resource;  ///< allocator to forward requests to
+
+  /**
+   * Get default resource method
+   * @return pointer to the shared malloc/free based resource
+   */
+  static allocator_interface_t* DefaultResource() noexcept {
+    static allocator_adapter_t<simple_allocator_t> defaultResource;
+
+    return &defaultResource;
+  }
+public:
+  /**
+   * Default constructor (uses malloc/free based resource)
+   */
+  polymorphic_allocator_t() noexcept : resource(DefaultResource()) {}
+
+  /**
+   * Constructor from allocator interface
+   * @param[in] resource pointer to allocator to forward requests to
+   */
+  polymorphic_allocator_t(allocator_interface_t* resource) noexcept : resource(resource ? resource : DefaultResource()) {}
+
+  /**
+   * A method that allocates a block of size 'size'
+   *
+   * @param[in] size number of bytes to allocate
+   * @return pointer to allocated memory
+   */
+  void* alloc(size_t size) {
+    return resource->alloc(size);
+  }
+
+  /**
+   * Dealocation a block by pointer
+   *
+   * @param[in] data pointer to block
+   */
+  void dealloc(void* data) {
+    resource->dealloc(data);
+  }
+
+  /**
+   * Get resource method
+   * @return pointer to allocator requests are forwarded to
+   */
+  allocator_interface_t* Resource() const noexcept {
+    return resource;
+  }
+
+  /**
+   * Comparison operator ==
+   * @param[in] allocator allocator we want to compare with
+   * @return true if both forward to the same resource, false otherwise
+   */
+  bool operator==(polymorphic_allocator_t const& allocator) const noexcept {
+    return resource == allocator.resource;
+  }
 };
\ No newline at end of file
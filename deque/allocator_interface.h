@@ -3,10 +3,147 @@
 #ifndef __ALLOCATOR_INTERFACE_H_INCLUDED
 #define __ALLOCATOR_INTERFACE_H_INCLUDED
 
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Deque allocator concept
+ *
+ * Compile-time requirements for allocators used in a deque: default construction,
+ * alloc(size) returning memory and dealloc(pointer) returning it back.
+ * Allocators are called statically, no virtual dispatch is involved
+ */
+template <typename alloc>
+concept deque_allocator = std::default_initializable<alloc> && requires(alloc a, void* data, size_t size) {
+  { a.alloc(size) } -> std::convertible_to<void*>;
+  a.dealloc(data);
+};
+
+/**
+ * @brief Bulk release allocator concept
+ *
+ * Allocators whose dealloc does nothing and that release all memory at once (declared by static 'bulkRelease' flag),
+ * so containers may drop their blocks without returning them one by one
+ */
+template <typename alloc>
+concept bulk_release_allocator = deque_allocator<alloc> && requires { requires alloc::bulkRelease; };
+
+/**
+ * @brief Thread-safe allocator concept
+ *
+ * Allocators that may be called from several threads at once (declared by static 'threadSafe' flag)
+ */
+template <typename alloc>
+concept thread_safe_allocator = deque_allocator<alloc> && requires { requires alloc::threadSafe; };
+
+/**
+ * @brief Fixed slot allocator concept
+ *
+ * Allocators that serve requests of one size only (declared by static 'fixedSlot' flag), e.g. pool_allocator_t.
+ * Containers take only their equal-sized blocks from them and allocate variable-sized bookkeeping elsewhere;
+ * containers whose element storage changes in size reject them at compile time
+ */
+template <typename alloc>
+concept fixed_slot_allocator = deque_allocator<alloc> && requires { requires alloc::fixedSlot; };
+
+/**
+ * @brief Aligned allocator concept
+ *
+ * Allocators that serve alignments stricter than their default one directly:
+ * alloc(size, align) returns memory aligned to 'align' and dealloc(pointer, align) returns it back
+ */
+template <typename alloc>
+concept aligned_deque_allocator = deque_allocator<alloc> && requires(alloc a, void* data, size_t size, size_t align) {
+  { a.alloc(size, align) } -> std::convertible_to<void*>;
+  a.dealloc(data, align);
+};
+
+/**
+ * Get alignment of blocks returned by alloc(size)
+ * @tparam alloc allocator type
+ * @return 'alignment' declared by the allocator or alignof(std::max_align_t) if it declares nothing
+ */
+template <typename alloc>
+constexpr size_t AllocatorAlignment() noexcept {
+  if constexpr (requires { alloc::alignment; })
+    return alloc::alignment;
+  else
+    return alignof(std::max_align_t);
+}
+
+/**
+ * Get number of bytes AllocAligned requests from the allocator
+ * @tparam align required alignment (a power of two)
+ * @tparam alloc allocator type
+ * @param[in] size number of bytes to allocate
+ * @return 'size' plus room for alignment if the allocator cannot align the block itself
+ */
+template <size_t align, typename alloc>
+constexpr size_t AlignedAllocSize(size_t size) noexcept {
+  return align <= AllocatorAlignment<alloc>() || aligned_deque_allocator<alloc> ? size : size + align;
+}
+
+/**
+ * Allocate block aligned to 'align'
+ *
+ * Alignments up to the default one of the allocator are served by alloc(size), stricter ones by alloc(size, align)
+ * if the allocator has it; otherwise a larger block is allocated and the original pointer is kept right before the aligned one
+ * @tparam align required alignment (a power of two)
+ * @tparam alloc allocator type
+ * @param[in] allocator allocator to use
+ * @param[in] size number of bytes to allocate
+ * @return pointer to allocated memory (nullptr if the allocator returns nullptr)
+ * @see DeallocAligned
+ */
+template <size_t align, deque_allocator alloc>
+void* AllocAligned(alloc& allocator, size_t size) {
+  static_assert((align & (align - 1)) == 0, "Alignment must be a power of two");
+
+  if constexpr (align <= AllocatorAlignment<alloc>())
+    return allocator.alloc(size);
+  else if constexpr (aligned_deque_allocator<alloc>)
+    return allocator.alloc(size, align);
+  else {
+    static_assert(AllocatorAlignment<alloc>() >= alignof(void*), "Allocator must align blocks at least for a pointer");
+
+    char* raw = (char*)allocator.alloc(AlignedAllocSize<align, alloc>(size));
+
+    if (raw == nullptr)
+      return nullptr;
+
+    char* data = raw + (align - (uintptr_t)raw % align);
+
+    ((void**)data)[-1] = raw;
+
+    return data;
+  }
+}
+
+/**
+ * Deallocate block allocated by AllocAligned with the same alignment
+ * @tparam align alignment the block was allocated with
+ * @tparam alloc allocator type
+ * @param[in] allocator allocator to use
+ * @param[in] data pointer to block
+ */
+template <size_t align, deque_allocator alloc>
+void DeallocAligned(alloc& allocator, void* data) {
+  if constexpr (align <= AllocatorAlignment<alloc>())
+    allocator.dealloc(data);
+  else if constexpr (aligned_deque_allocator<alloc>)
+    allocator.dealloc(data, align);
+  else if (data)
+    allocator.dealloc(((void**)data)[-1]);
+}
+
 /**
  * @brief Minimal allocator interface
  *
- * Base class for allocators used in a deque
+ * Base class for runtime-polymorphic allocators, used in a deque through polymorphic_allocator_t
+ * @see polymorphic_allocator_t
  */
 class allocator_interface_t {
 public:
@@ -24,6 +161,100 @@ public:
    * @param[in] data pointer to block
    */
   virtual void dealloc(void* data) = 0;
+
+  /**
+   * Virtual destructor
+   */
+  virtual ~allocator_interface_t() = default;
+};
+
+/**
+ * @brief Allocator holder
+ *
+ * Base class storing the allocator of a container.
+ * Empty allocators are stored as a base class, so thanks to empty base optimization they take no space
+ * @tparam memoryAllocator the allocator to be stored
+ */
+template <typename memoryAllocator, bool isEmpty = std::is_empty_v<memoryAllocator> && !std::is_final_v<memoryAllocator>>
+class allocator_holder_t : private memoryAllocator {
+public:
+  /**
+   * Default constructor
+   */
+  allocator_holder_t() = default;
+
+  /**
+   * Constructor from allocator
+   * @param[in] allocator allocator to store
+   */
+  explicit allocator_holder_t(memoryAllocator const& allocator) : memoryAllocator(allocator) {}
+
+  /**
+   * Constructor from allocator (move semantics)
+   * @param[in] allocator allocator to store
+   */
+  explicit allocator_holder_t(memoryAllocator&& allocator) : memoryAllocator(std::move(allocator)) {}
+
+  /**
+   * Get stored allocator method
+   * @return reference on stored allocator
+   */
+  memoryAllocator& Allocator() noexcept {
+    return *this;
+  }
+
+  /**
+   * Get stored allocator method
+   * @return const reference on stored allocator
+   */
+  memoryAllocator const& Allocator() const noexcept {
+    return *this;
+  }
+};
+
+/**
+ * @brief Allocator holder (non-empty allocators)
+ *
+ * Stores the allocator as a member
+ * @tparam memoryAllocator the allocator to be stored
+ */
+template <typename memoryAllocator>
+class allocator_holder_t<memoryAllocator, false> {
+private:
+  memoryAllocator allocator;  ///< stored allocator
+public:
+  /**
+   * Default constructor
+   */
+  allocator_holder_t() = default;
+
+  /**
+   * Constructor from allocator
+   * @param[in] allocator allocator to store
+   */
+  explicit allocator_holder_t(memoryAllocator const& allocator) : allocator(allocator) {}
+
+  /**
+   * Constructor from allocator (move semantics)
+   * @param[in] allocator allocator to store
+   */
+  explicit allocator_holder_t(memoryAllocator&& allocator) : allocator(std::move(allocator)) {}
+
+  /**
+   * Get stored allocator method
+   * @return reference on stored allocator
+   */
+  memoryAllocator& Allocator() noexcept {
+    return allocator;
+  }
+
+  /**
+   * Get stored allocator method
+   * @return const reference on stored allocator
+   */
+  memoryAllocator const& Allocator() const noexcept {
+    return allocator;
+  }
 };
 
-#endif /* __ALLOCATOR_INTERFACE_H_INCLUDED */
\ No newline at end of file
+#endif /* __ALLOCATOR_INTERFACE_H_INCLUDED */
@@ -0,0 +1,339 @@
+#pragma once
+
+#include <coroutine>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "deque.h"
+#include "concurrent_deque.h"
+#include "intrusive_deque.h"
+
+/**
+ * @brief Asynchronous deque class
+ *
+ * Multi-producer multi-consumer FIFO queue for C++20 coroutines: 'co_await PopFront()' suspends the consumer
+ * while the queue is empty and 'co_await PushBack(elem)' suspends the producer while the queue is full.
+ * A push to a queue with waiting consumers moves the element straight into the first waiter and resumes it,
+ * a pop from a full queue moves the element of the first waiting producer into the queue and resumes it.
+ * Waiters are resumed inline in the thread that wakes them, after the lock of the queue is released
+ * @tparam elemType type of stored elements
+ * @tparam memoryAllocator the allocator to be used for buffered elements
+ * @warning no coroutine may wait on the queue when it is destroyed (call Close() and let the waiters finish first)
+ * @see deque_allocator
+ */
+template <typename elemType, deque_allocator memoryAllocator = simple_allocator_t>
+class async_deque_t {
+public:
+  /**
+   * @brief Pop awaiter
+   *
+   * Result of PopFront(), 'co_await' on it gives the first element or std::nullopt if the queue is closed and empty
+   */
+  class pop_awaiter_t {
+  private:
+    friend class async_deque_t;
+
+    async_deque_t& deque;                     ///< queue to take element from
+    std::optional<elemType> value;            ///< taken element
+    std::coroutine_handle<> handle;           ///< suspended consumer
+    intrusive_hook_t<pop_awaiter_t> hook;     ///< links in the waiters of the queue
+
+    /**
+     * Pop awaiter constructor
+     * @param[in] deque queue to take element from
+     */
+    explicit pop_awaiter_t(async_deque_t& deque) noexcept : deque(deque) {}
+  public:
+    pop_awaiter_t(pop_awaiter_t const&) = delete;
+    pop_awaiter_t& operator=(pop_awaiter_t const&) = delete;
+
+    /**
+     * Try to take element without suspending
+     * @return true if the element is taken or the queue is closed
+     */
+    bool await_ready() {
+      return deque.Take(*this, false);
+    }
+
+    /**
+     * Take element or suspend the consumer until an element arrives
+     * @param[in] consumer handle of the awaiting coroutine
+     * @return true if the coroutine is suspended, false to continue it at once
+     */
+    bool await_suspend(std::coroutine_handle<> consumer) {
+      handle = consumer;
+      return !deque.Take(*this, true);
+    }
+
+    /**
+     * Get taken element
+     * @returns moved element or std::nullopt if the queue is closed and empty
+     */
+    std::optional<elemType> await_resume() noexcept(std::is_nothrow_move_constructible_v<elemType>) {
+      return std::move(value);
+    }
+  };
+
+  /**
+   * @brief Push awaiter
+   *
+   * Result of PushBack(), 'co_await' on it gives true if the element is stored or false if the queue is closed
+   */
+  class push_awaiter_t {
+  private:
+    friend class async_deque_t;
+
+    async_deque_t& deque;                     ///< queue to put element to
+    elemType elem;                            ///< element to put
+    bool stored;                              ///< true if the element is given away
+    std::coroutine_handle<> handle;           ///< suspended producer
+    intrusive_hook_t<push_awaiter_t> hook;    ///< links in the waiters of the queue
+
+    /**
+     * Push awaiter constructor
+     * @tparam type type of element
+     * @param[in] deque queue to put element to
+     * @param[in] elem element to put
+     */
+    template <typename type>
+    push_awaiter_t(async_deque_t& deque, type&& elem) : deque(deque), elem(std::forward<type>(elem)), stored(false) {}
+  public:
+    push_awaiter_t(push_awaiter_t const&) = delete;
+    push_awaiter_t& operator=(push_awaiter_t const&) = delete;
+
+    /**
+     * Try to put element without suspending
+     * @return true if the element is stored or the queue is closed
+     */
+    bool await_ready() {
+      return deque.Put(*this, false);
+    }
+
+    /**
+     * Put element or suspend the producer until there is room for it
+     * @param[in] producer handle of the awaiting coroutine
+     * @return true if the coroutine is suspended, false to continue it at once
+     */
+    bool await_suspend(std::coroutine_handle<> producer) {
+      handle = producer;
+      return !deque.Put(*this, true);
+    }
+
+    /**
+     * Get result of the push
+     * @return true if the element is stored, false if the queue is closed (the element is dropped)
+     */
+    bool await_resume() const noexcept {
+      return stored;
+    }
+  };
+
+private:
+  mutable spin_lock_t lock;                                                   ///< lock of the queue
+  deque_t<elemType, memoryAllocator> items;                                   ///< buffered elements
+  intrusive_deque_t<pop_awaiter_t, &pop_awaiter_t::hook> consumers;           ///< suspended consumers (only while 'items' is empty)
+  intrusive_deque_t<push_awaiter_t, &push_awaiter_t::hook> producers;         ///< suspended producers (only while 'items' is full)
+  size_t capacity;                                                            ///< maximum number of buffered elements
+  bool closed;                                                                ///< true after Close()
+
+  /**
+   * Take element for the consumer or register it as a waiter
+   *
+   * A waiting producer is removed from the waiters only after its element is moved, so if the move throws,
+   * the producer keeps waiting and can still be woken by Close()
+   * @param[in] consumer awaiter receiving the element
+   * @param[in] wait true to put the consumer into the waiters if there is no element
+   * @return true if the pop is complete (element taken or queue closed), false otherwise
+   */
+  bool Take(pop_awaiter_t& consumer, bool wait) {
+    push_awaiter_t* producer = nullptr;
+
+    {
+      std::lock_guard<spin_lock_t> guard(lock);
+
+      if (!items.IsEmpty()) {
+        consumer.value.emplace(std::move(items.GetFront()));
+        items.PopFront();
+
+        if ((producer = producers.TryPeekHead()) != nullptr) {
+          items.PushBack(std::move(producer->elem));
+          producers.Remove(*producer);
+        }
+      }
+      else if ((producer = producers.TryPeekHead()) != nullptr) {
+        consumer.value.emplace(std::move(producer->elem));
+        producers.Remove(*producer);
+      }
+      else if (!closed) {
+        if (wait)
+          consumers.PushBack(consumer);
+        return false;
+      }
+
+      if (producer)
+        producer->stored = true;
+    }
+
+    if (producer)
+      producer->handle.resume();
+    return true;
+  }
+
+  /**
+   * Give element of the producer to a waiting consumer, buffer it or register the producer as a waiter
+   *
+   * A waiting consumer is removed from the waiters only after the element is moved into it
+   * @param[in] producer awaiter holding the element
+   * @param[in] wait true to put the producer into the waiters if the queue is full
+   * @return true if the push is complete (element given away or queue closed), false otherwise
+   */
+  bool Put(push_awaiter_t& producer, bool wait) {
+    pop_awaiter_t* consumer = nullptr;
+
+    {
+      std::lock_guard<spin_lock_t> guard(lock);
+
+      if (closed)
+        return true;
+
+      if ((consumer = consumers.TryPeekHead()) != nullptr) {
+        consumer->value.emplace(std::move(producer.elem));
+        consumers.Remove(*consumer);
+      }
+      else if (items.Size() < capacity)
+        items.PushBack(std::move(producer.elem));
+      else {
+        if (wait)
+          producers.PushBack(producer);
+        return false;
+      }
+
+      producer.stored = true;
+    }
+
+    if (consumer)
+      consumer->handle.resume();
+    return true;
+  }
+public:
+  /**
+   * Queue constructor
+   * @param[in] capacity maximum number of buffered elements (0 makes every push wait for a consumer)
+   * @param[in] allocator allocator of buffered elements
+   */
+  explicit async_deque_t(size_t capacity = SIZE_MAX, memoryAllocator const& allocator = memoryAllocator())
+    : items(allocator), capacity(capacity), closed(false) {}
+
+  async_deque_t(async_deque_t const&) = delete;
+  async_deque_t& operator=(async_deque_t const&) = delete;
+
+  /**
+   * Get capacity method
+   * @return maximum number of buffered elements
+   */
+  size_t Capacity() const noexcept {
+    return capacity;
+  }
+
+  /**
+   * Get queue size method
+   * @return number of buffered elements (a snapshot that may be outdated at once)
+   */
+  size_t Size() const {
+    std::lock_guard<spin_lock_t> guard(lock);
+
+    return items.Size();
+  }
+
+  /**
+   * Check is queue empty method
+   * @return true if no elements are buffered, false otherwise (a snapshot that may be outdated at once)
+   */
+  bool IsEmpty() const {
+    return Size() == 0;
+  }
+
+  /**
+   * Check is queue closed method
+   * @return true if Close() was called, false otherwise
+   */
+  bool IsClosed() const {
+    std::lock_guard<spin_lock_t> guard(lock);
+
+    return closed;
+  }
+
+  /**
+   * Method to take first element (suspends the awaiting coroutine while the queue is empty)
+   * @return awaiter giving the moved element or std::nullopt if the queue is closed and empty
+   */
+  [[nodiscard]] pop_awaiter_t PopFront() noexcept {
+    return pop_awaiter_t(*this);
+  }
+
+  /**
+   * Method put element to end (suspends the awaiting coroutine while the queue is full, copy semantics)
+   * @param[in] elem const reference on element
+   * @return awaiter giving true if the element is stored, false if the queue is closed
+   */
+  [[nodiscard]] push_awaiter_t PushBack(elemType const& elem) {
+    return push_awaiter_t(*this, elem);
+  }
+
+  /**
+   * Method put element to end (suspends the awaiting coroutine while the queue is full, move semantics)
+   * @param[in] elem rvalue reference on element
+   * @return awaiter giving true if the element is stored, false if the queue is closed
+   */
+  [[nodiscard]] push_awaiter_t PushBack(elemType&& elem) {
+    return push_awaiter_t(*this, std::move(elem));
+  }
+
+  /**
+   * Method to take first element without waiting (for callers outside coroutines)
+   * @returns moved element or std::nullopt if the queue is empty
+   */
+  std::optional<elemType> TryPopFront() {
+    pop_awaiter_t consumer(*this);
+
+    Take(consumer, false);
+    return std::move(consumer.value);
+  }
+
+  /**
+   * Method put element to end without waiting (for callers outside coroutines)
+   * @param[in] elem element to put
+   * @return true if the element is stored, false if the queue is full or closed
+   */
+  bool TryPushBack(elemType elem) {
+    push_awaiter_t producer(*this, std::move(elem));
+
+    Put(producer, false);
+    return producer.stored;
+  }
+
+  /**
+   * Close the queue: waiting consumers get std::nullopt, waiting producers get false,
+   * further pushes fail and pops drain the buffered elements
+   */
+  void Close() {
+    intrusive_deque_t<pop_awaiter_t, &pop_awaiter_t::hook> idleConsumers;
+    intrusive_deque_t<push_awaiter_t, &push_awaiter_t::hook> idleProducers;
+
+    {
+      std::lock_guard<spin_lock_t> guard(lock);
+
+      closed = true;
+      idleConsumers = std::move(consumers);
+      idleProducers = std::move(producers);
+    }
+
+    while (pop_awaiter_t* consumer = idleConsumers.TryPopFront())
+      consumer->handle.resume();
+
+    while (push_awaiter_t* producer = idleProducers.TryPopFront())
+      producer->handle.resume();
+  }
+};
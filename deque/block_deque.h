@@ -0,0 +1,1908 @@
+﻿#pragma once
+
+#include <iostream>
+#include <exception>
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <iterator>
+#include <ranges>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
+#include <utility>
+#include "allocator.h"
+#include "iterator_policy.h"
+#include "parallel.h"
+#include "simd.h"
+#include "stream_writer.h"
+#include "snapshot.h"
+
+using std::exception;
+
+/**
+ * Default number of elements in one block of the block deque
+ * @tparam elemType type of stored elements
+ * @return number of elements that fit into 512 bytes (at least one)
+ */
+template <typename elemType>
+constexpr size_t DefaultBlockSize() {
+  return sizeof(elemType) < 512 ? 512 / sizeof(elemType) : 1;
+}
+
+/**
+ * @brief Deque class with block storage
+ *
+ * Stores elements in fixed-size contiguous blocks addressed through a map of block pointers,
+ * so one allocation serves 'blockSize' elements and no links are kept per element
+ * @tparam elemType type of stored elements
+ * @tparam memoryAllocator the allocator to be used (allocator based on malloc/free is used by default)
+ * @tparam blockSize number of elements in one block
+ * @warning any push may invalidate iterators
+ * @see deque_allocator
+ * @see deque_t
+ */
+template <typename elemType, deque_allocator memoryAllocator = simple_allocator_t, size_t blockSize = DefaultBlockSize<elemType>()>
+class block_deque_t : private allocator_holder_t<memoryAllocator> {
+private:
+  using holder_t = allocator_holder_t<memoryAllocator>;
+  using holder_t::Allocator;
+
+  static_assert(blockSize > 0, "Block must contain at least one element");
+
+  static constexpr size_t initialMapSize = 8;   ///< number of map entries allocated by the first push
+  static constexpr bool separateMap = fixed_slot_allocator<memoryAllocator>;   ///< true if the map is allocated by malloc
+
+
+  elemType** map;             ///< array of pointers to blocks (nullptr if the block is not allocated)
+  size_t mapSize;             ///< number of entries in the map
+  size_t first;               ///< position of the first element counted from the beginning of the first map block
+  size_t size;                ///< number of elements in the deque
+
+  /**
+   * Get the storage of the element at the given map position
+   * @param[in] pos position counted from the beginning of the first map block
+   * @return pointer to the element storage
+   */
+  elemType* Slot(size_t pos) const noexcept {
+    return map[pos / blockSize] + pos % blockSize;
+  }
+
+  /**
+   * Allocate map of block pointers
+   *
+   * Slot allocators (pool_allocator_t) serve requests of one size only, so with them blocks come from the allocator
+   * and the map, whose size changes, comes from simple_allocator_t
+   * @param[in] entries number of map entries
+   * @return pointer to allocated map (entries are not initialized)
+   * @exception "Block deque is out of memory" if the map cannot be allocated
+   */
+  elemType** AllocMap(size_t entries) {
+    elemType** data = nullptr;
+
+    if (entries <= SIZE_MAX / sizeof(elemType*)) {
+      if constexpr (separateMap)
+        data = (elemType**)simple_allocator_t().alloc(entries * sizeof(elemType*));
+      else
+        data = (elemType**)Allocator().alloc(entries * sizeof(elemType*));
+    }
+
+    if (data == nullptr)
+      throw exception("Block deque is out of memory");
+
+    return data;
+  }
+
+  /**
+   * Deallocate map of block pointers
+   * @param[in] data pointer to map allocated by AllocMap
+   */
+  void DeallocMap(elemType** data) noexcept {
+    if constexpr (separateMap)
+      simple_allocator_t().dealloc((void*)data);
+    else
+      Allocator().dealloc((void*)data);
+  }
+
+  /**
+   * Get the storage for position and allocate its block if necessary
+   * @param[in] pos position counted from the beginning of the first map block
+   * @return pointer to the element storage
+   * @exception "Block deque is out of memory" if the block cannot be allocated
+   */
+  elemType* AcquireSlot(size_t pos) {
+    elemType*& block = map[pos / blockSize];
+
+    if (block == nullptr) {
+      block = (elemType*)AllocAligned<alignof(elemType)>(Allocator(), blockSize * sizeof(elemType));
+
+      if (block == nullptr)
+        throw exception("Block deque is out of memory");
+    }
+
+    return block + pos % blockSize;
+  }
+
+  /**
+   * Put the first position of the empty deque into the middle of the map
+   */
+  void Recenter() noexcept {
+    first = map ? mapSize / 2 * blockSize + blockSize / 2 : 0;
+  }
+
+  /**
+   * Make room for blocks at both ends of the deque
+   *
+   * Used blocks are moved to the middle of the map; if the map is too small, it is doubled.
+   * Block pointers are only permuted, so elements are never moved and spare blocks are kept
+   * @param[in] extraFront number of free map entries required before the first used block
+   * @param[in] extraBack number of free map entries required after the last used block
+   * @exception "Block deque is out of memory" if the map cannot be allocated or would not fit in memory
+   */
+  void GrowMap(size_t extraFront = 1, size_t extraBack = 1) {
+    size_t firstBlock = size == 0 ? 0 : first / blockSize;
+    size_t usedBlocks = size == 0 ? 1 : (first + size - 1) / blockSize - firstBlock + 1;
+
+    if (extraFront > SIZE_MAX / 8 || extraBack > SIZE_MAX / 8 - extraFront || usedBlocks > SIZE_MAX / 8 - extraFront - extraBack)
+      throw exception("Block deque is out of memory");
+
+    size_t neededBlocks = usedBlocks + extraFront + extraBack;
+    size_t newMapSize = mapSize;
+
+    if (mapSize < 2 * neededBlocks)
+      newMapSize = std::max({ initialMapSize, 2 * mapSize, 2 * neededBlocks });
+
+    size_t newFirstBlock = extraFront + (newMapSize - neededBlocks) / 2;
+
+    if (newMapSize == mapSize) {
+      size_t shift = (newFirstBlock + mapSize - firstBlock) % mapSize;
+
+      std::rotate(map, map + (mapSize - shift) % mapSize, map + mapSize);
+    }
+    else {
+      elemType** newMap = AllocMap(newMapSize);
+
+      std::fill(newMap, newMap + newMapSize, nullptr);
+      for (size_t i = 0; i < mapSize; i++)
+        newMap[(newFirstBlock + i) % newMapSize] = map[(firstBlock + i) % mapSize];
+
+      if (map)
+        DeallocMap(map);
+
+      map = newMap;
+      mapSize = newMapSize;
+    }
+
+    first = newFirstBlock * blockSize + (size == 0 ? blockSize / 2 : first % blockSize);
+  }
+
+  /**
+   * Make room for 'count' elements before the first one
+   * @param[in] count number of elements
+   */
+  void ReserveFront(size_t count) {
+    if (count > first)
+      GrowMap((count + blockSize - 1) / blockSize + 1, 1);
+  }
+
+  /**
+   * Make room for 'count' elements after the last one
+   * @param[in] count number of elements
+   */
+  void ReserveBack(size_t count) {
+    if (count > mapSize * blockSize - first - size)
+      GrowMap(1, (count + blockSize - 1) / blockSize + 1);
+  }
+
+  /**
+   * Destroy all stored elements
+   */
+  void DestroyElements() noexcept {
+    if (!std::is_trivially_destructible<elemType>::value)
+      for (size_t i = 0; i < size; i++)
+        Slot(first + i)->~elemType();
+  }
+
+  /**
+   * Free all blocks and the map
+   */
+  void ReleaseStorage() noexcept {
+    if constexpr (!bulk_release_allocator<memoryAllocator> || separateMap) {
+      if constexpr (!bulk_release_allocator<memoryAllocator>)
+        for (size_t i = 0; i < mapSize; i++)
+          if (map[i])
+            DeallocAligned<alignof(elemType)>(Allocator(), (void*)map[i]);
+
+      if (map)
+        DeallocMap(map);
+    }
+
+    map = nullptr;
+    mapSize = 0;
+    first = 0;
+  }
+
+  /**
+   * Take storage of other deque leaving it empty
+   * @param[in] deque reference on deque to take storage from
+   */
+  void Steal(block_deque_t& deque) noexcept {
+    map = deque.map;
+    mapSize = deque.mapSize;
+    first = deque.first;
+    size = deque.size;
+
+    deque.map = nullptr;
+    deque.mapSize = 0;
+    deque.first = 0;
+    deque.size = 0;
+  }
+
+  /**
+   * Replace elements with copies of elements of other deque (the deque is not changed if a constructor or an allocation throws)
+   *
+   * Trivially copyable elements are copied with memcpy block by block: the first position gets the offset inside
+   * block of the other deque, so blocks match one to one, and all blocks are allocated before elements are touched.
+   * Nothrow copy assignable elements are assigned in place and only the size difference is constructed or destroyed.
+   * Other elements are copied to the end before old ones are removed.
+   * Allocated blocks are reused in all cases
+   * @param[in] deque const reference on deque to copy
+   */
+  void Assign(block_deque_t const& deque) {
+    if constexpr (std::is_trivially_copyable_v<elemType>) {
+      if (deque.size == 0) {
+        Clear();
+        return;
+      }
+
+      size_t blocks = (deque.first % blockSize + deque.size - 1) / blockSize + 1;
+
+      if (mapSize < 2 * blocks)
+        GrowMap(1, blocks);
+
+      size_t firstBlock = mapSize / 2;
+
+      for (size_t b = firstBlock; b < firstBlock + blocks; b++)
+        AcquireSlot(b * blockSize);
+
+      first = firstBlock * blockSize + deque.first % blockSize;
+      size = 0;
+      deque.ForEachPiece(0, 1, [this](elemType const* from, elemType const* to) {
+        std::memcpy((void*)Slot(first + size), (void const*)from, (to - from) * sizeof(elemType));
+        size += to - from;
+      });
+    }
+    else if constexpr (std::is_nothrow_copy_assignable_v<elemType>) {
+      size_t common = std::min(size, deque.size);
+
+      if (deque.size > size)
+        PushBackRange(deque.begin() + (ptrdiff_t)size, deque.end());
+
+      for (size_t i = 0; i < common; i++)
+        *Slot(first + i) = *deque.Slot(deque.first + i);
+
+      while (size > deque.size)
+        PopBack();
+    }
+    else {
+      size_t old = size;
+
+      PushBackRange(deque.begin(), deque.end());
+
+      for (; old; old--)
+        PopFront();
+    }
+  }
+
+  /**
+   * Get number of segments for parallel algorithms (segments never share a block)
+   * @param[in] threadCount requested number of threads (0 to use all hardware threads)
+   * @return number of segments (0 if deque is empty)
+   */
+  size_t SegmentCount(unsigned threadCount) const {
+    if (size == 0)
+      return 0;
+
+    size_t blocks = (first + size - 1) / blockSize - first / blockSize + 1;
+
+    return std::min(ParallelSegmentCount(size, threadCount), blocks);
+  }
+
+  /**
+   * Call function for every contiguous piece of elements of a segment
+   * @tparam func type of function called as func(from, to) with pointers to the piece
+   * @param[in] segment index of the segment
+   * @param[in] segments number of segments
+   * @param[in] f function to call
+   */
+  template <typename func>
+  void ForEachPiece(size_t segment, size_t segments, func&& f) const {
+    size_t firstBlock = first / blockSize;
+    size_t blocks = (first + size - 1) / blockSize - firstBlock + 1;
+    size_t from = firstBlock + blocks * segment / segments, to = firstBlock + blocks * (segment + 1) / segments;
+
+    for (size_t b = from; b < to; b++) {
+      size_t begin = std::max(first, b * blockSize), end = std::min(first + size, (b + 1) * blockSize);
+
+      f(map[b] + (begin - b * blockSize), map[b] + (end - b * blockSize));
+    }
+  }
+public:
+  class const_iterator;
+
+  /**
+   * @brief Block deque iterator
+   *
+   * Allows to iterate in direct order in deque with random access (element k is reached in O(1))
+   */
+  class iterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;   ///< iterator category for standard algorithms
+    using value_type = elemType;                                 ///< type of elements
+    using difference_type = ptrdiff_t;                           ///< type of distance between iterators
+    using pointer = elemType*;                                   ///< pointer to element
+    using reference = elemType&;                                 ///< reference on element
+  private:
+    block_deque_t* deque;   ///< Pointer to the iterated deque
+    size_t index;           ///< Index of the element to which the iterator corresponds
+
+    friend class const_iterator;
+
+    /**
+     * Move iterator by 'offset' elements
+     * @param[in] offset number of elements to move by (negative to move backward)
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    void Advance(difference_type offset) noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || (offset < 0 && (size_t)-offset > index) || (offset > 0 && (size_t)offset > deque->size - index))
+          throw exception("Iterator is out of range");
+
+      index += offset;
+    }
+  public:
+    /**
+     * Default constructor for iterator
+     */
+    iterator() : deque(nullptr), index(0) {}
+
+    /**
+     * Constructor from deque and element index
+     * @param[in] deque pointer to the iterated deque
+     * @param[in] index index of the element we want to build iterator from
+     */
+    iterator(block_deque_t* deque, size_t index) : deque(deque), index(index) {}
+
+    /**
+     * Prefix ++ operator
+     * @return reference to next iterator
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || index >= deque->size)
+          throw exception("Try to use end iterator");
+
+      index++;
+
+      return *this;
+    }
+
+    /**
+     * Postfix ++ operator
+     * @return reference to current iterator
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    iterator operator++(int) noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      ++*this;
+
+      return tmp;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to previous iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    iterator& operator--() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || index == 0)
+          throw exception("Iterator is out of range");
+
+      index--;
+
+      return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    iterator operator--(int) noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      --*this;
+
+      return tmp;
+    }
+
+    /**
+     * Operator +=
+     * @param[in] offset number of elements to move forward by
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    iterator& operator+=(difference_type offset) noexcept(!checkedIterators) {
+      Advance(offset);
+
+      return *this;
+    }
+
+    /**
+     * Operator -=
+     * @param[in] offset number of elements to move backward by
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    iterator& operator-=(difference_type offset) noexcept(!checkedIterators) {
+      Advance(-offset);
+
+      return *this;
+    }
+
+    /**
+     * Operator +
+     * @param[in] offset number of elements to move forward by
+     * @return moved iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    iterator operator+(difference_type offset) const noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      return tmp += offset;
+    }
+
+    /**
+     * Operator + with offset on the left
+     * @param[in] offset number of elements to move forward by
+     * @param[in] iter iterator to move
+     * @return moved iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    friend iterator operator+(difference_type offset, iterator const& iter) noexcept(!checkedIterators) {
+      return iter + offset;
+    }
+
+    /**
+     * Operator -
+     * @param[in] offset number of elements to move backward by
+     * @return moved iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    iterator operator-(difference_type offset) const noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      return tmp -= offset;
+    }
+
+    /**
+     * Distance between iterators of the same deque
+     * @param[in] iter iterator we want to count distance from
+     * @return number of elements from 'iter' to current iterator
+     */
+    difference_type operator-(iterator const& iter) const noexcept {
+      return (difference_type)index - (difference_type)iter.index;
+    }
+
+    /**
+     * Comparison operator ==
+     * @param[in] iter iterator we want to compare with
+     * @return true if equals, false otherwise
+     */
+    bool operator==(iterator const& iter) const noexcept {
+      return deque == iter.deque && index == iter.index;
+    }
+
+    /**
+     * Comparison operator !=
+     * @param[in] iter iterator we want to compare with
+     * @return false if equals, true otherwise
+     */
+    bool operator!=(iterator const& iter) const noexcept {
+      return !(*this == iter);
+    }
+
+    /**
+     * Comparison operator < (for iterators of the same deque)
+     * @param[in] iter iterator we want to compare with
+     * @return true if current iterator corresponds earlier element, false otherwise
+     */
+    bool operator<(iterator const& iter) const noexcept {
+      return index < iter.index;
+    }
+
+    /**
+     * Comparison operator > (for iterators of the same deque)
+     * @param[in] iter iterator we want to compare with
+     * @return true if current iterator corresponds later element, false otherwise
+     */
+    bool operator>(iterator const& iter) const noexcept {
+      return iter < *this;
+    }
+
+    /**
+     * Comparison operator <= (for iterators of the same deque)
+     * @param[in] iter iterator we want to compare with
+     * @return false if current iterator corresponds later element, true otherwise
+     */
+    bool operator<=(iterator const& iter) const noexcept {
+      return !(iter < *this);
+    }
+
+    /**
+     * Comparison operator >= (for iterators of the same deque)
+     * @param[in] iter iterator we want to compare with
+     * @return false if current iterator corresponds earlier element, true otherwise
+     */
+    bool operator>=(iterator const& iter) const noexcept {
+      return !(*this < iter);
+    }
+
+    /**
+     * Operator *
+     * @return reference on value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    reference operator*() const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || index >= deque->size)
+          throw exception("Try to use end iterator");
+
+      return *deque->Slot(deque->first + index);
+    }
+
+    /**
+     * Operator ->
+     * @return pointer to value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    pointer operator->() const noexcept(!checkedIterators) {
+      return &**this;
+    }
+
+    /**
+     * Operator []
+     * @param[in] offset offset of the element from current iterator
+     * @return reference on element
+     * @exception "Try to use end iterator" if the element is out of deque (checked iterators only)
+     */
+    reference operator[](difference_type offset) const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || (offset < 0 && (size_t)-offset > index) || (offset >= 0 && (size_t)offset >= deque->size - index))
+          throw exception("Try to use end iterator");
+
+      return *deque->Slot(deque->first + index + offset);
+    }
+  };
+
+  /**
+   * Method begin for iterator
+   * @return iterator that corresponds first element
+   */
+  iterator begin() {
+    return iterator(this, 0);
+  }
+
+  /**
+   * Method end for iterator
+   * @return iterator that corresponds element after last
+   */
+  iterator end() {
+    return iterator(this, size);
+  }
+
+  /**
+   * @brief Block deque const iterator
+   *
+   * Allows to iterate in direct order in deque with random access (does not allow changing elements)
+   */
+  class const_iterator {
+  public:
+    using iterator_category = std::random_access_iterator_tag;   ///< iterator category for standard algorithms
+    using value_type = elemType;                                 ///< type of elements
+    using difference_type = ptrdiff_t;                           ///< type of distance between iterators
+    using pointer = const elemType*;                             ///< pointer to element
+    using reference = const elemType&;                           ///< reference on element
+  private:
+    const block_deque_t* deque;   ///< Pointer to the iterated deque
+    size_t index;                 ///< Index of the element to which the iterator corresponds
+
+    /**
+     * Move iterator by 'offset' elements
+     * @param[in] offset number of elements to move by (negative to move backward)
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    void Advance(difference_type offset) noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || (offset < 0 && (size_t)-offset > index) || (offset > 0 && (size_t)offset > deque->size - index))
+          throw exception("Iterator is out of range");
+
+      index += offset;
+    }
+  public:
+    /**
+     * Default constructor for const iterator
+     */
+    const_iterator() : deque(nullptr), index(0) {}
+
+    /**
+     * Constructor from deque and element index
+     * @param[in] deque pointer to the iterated deque
+     * @param[in] index index of the element we want to build iterator from
+     */
+    const_iterator(const block_deque_t* deque, size_t index) : deque(deque), index(index) {}
+
+    /**
+     * Constructor from iterator
+     * @param[in] iter iterator to build const iterator from
+     */
+    const_iterator(iterator const& iter) : deque(iter.deque), index(iter.index) {}
+
+    /**
+     * Prefix ++ operator
+     * @return reference to next iterator
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    const_iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || index >= deque->size)
+          throw exception("Try to use end iterator");
+
+      index++;
+
+      return *this;
+    }
+
+    /**
+     * Postfix ++ operator
+     * @return reference to current iterator
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    const_iterator operator++(int) noexcept(!checkedIterators) {
+      const_iterator tmp = *this;
+
+      ++*this;
+
+      return tmp;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to previous iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    const_iterator& operator--() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || index == 0)
+          throw exception("Iterator is out of range");
+
+      index--;
+
+      return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    const_iterator operator--(int) noexcept(!checkedIterators) {
+      const_iterator tmp = *this;
+
+      --*this;
+
+      return tmp;
+    }
+
+    /**
+     * Operator +=
+     * @param[in] offset number of elements to move forward by
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    const_iterator& operator+=(difference_type offset) noexcept(!checkedIterators) {
+      Advance(offset);
+
+      return *this;
+    }
+
+    /**
+     * Operator -=
+     * @param[in] offset number of elements to move backward by
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    const_iterator& operator-=(difference_type offset) noexcept(!checkedIterators) {
+      Advance(-offset);
+
+      return *this;
+    }
+
+    /**
+     * Operator +
+     * @param[in] offset number of elements to move forward by
+     * @return moved iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    const_iterator operator+(difference_type offset) const noexcept(!checkedIterators) {
+      const_iterator tmp = *this;
+
+      return tmp += offset;
+    }
+
+    /**
+     * Operator + with offset on the left
+     * @param[in] offset number of elements to move forward by
+     * @param[in] iter iterator to move
+     * @return moved iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    friend const_iterator operator+(difference_type offset, const_iterator const& iter) noexcept(!checkedIterators) {
+      return iter + offset;
+    }
+
+    /**
+     * Operator -
+     * @param[in] offset number of elements to move backward by
+     * @return moved iterator
+     * @exception "Iterator is out of range" if the result is before first element or after end (checked iterators only)
+     */
+    const_iterator operator-(difference_type offset) const noexcept(!checkedIterators) {
+      const_iterator tmp = *this;
+
+      return tmp -= offset;
+    }
+
+    /**
+     * Distance between iterators of the same deque
+     * @param[in] iter iterator we want to count distance from
+     * @return number of elements from 'iter' to current iterator
+     */
+    difference_type operator-(const_iterator const& iter) const noexcept {
+      return (difference_type)index - (difference_type)iter.index;
+    }
+
+    /**
+     * Comparison operator ==
+     * @param[in] iter iterator we want to compare with
+     * @return true if equals, false otherwise
+     */
+    bool operator==(const_iterator const& iter) const noexcept {
+      return deque == iter.deque && index == iter.index;
+    }
+
+    /**
+     * Comparison operator !=
+     * @param[in] iter iterator we want to compare with
+     * @return false if equals, true otherwise
+     */
+    bool operator!=(const_iterator const& iter) const noexcept {
+      return !(*this == iter);
+    }
+
+    /**
+     * Comparison operator < (for iterators of the same deque)
+     * @param[in] iter iterator we want to compare with
+     * @return true if current iterator corresponds earlier element, false otherwise
+     */
+    bool operator<(const_iterator const& iter) const noexcept {
+      return index < iter.index;
+    }
+
+    /**
+     * Comparison operator > (for iterators of the same deque)
+     * @param[in] iter iterator we want to compare with
+     * @return true if current iterator corresponds later element, false otherwise
+     */
+    bool operator>(const_iterator const& iter) const noexcept {
+      return iter < *this;
+    }
+
+    /**
+     * Comparison operator <= (for iterators of the same deque)
+     * @param[in] iter iterator we want to compare with
+     * @return false if current iterator corresponds later element, true otherwise
+     */
+    bool operator<=(const_iterator const& iter) const noexcept {
+      return !(iter < *this);
+    }
+
+    /**
+     * Comparison operator >= (for iterators of the same deque)
+     * @param[in] iter iterator we want to compare with
+     * @return false if current iterator corresponds earlier element, true otherwise
+     */
+    bool operator>=(const_iterator const& iter) const noexcept {
+      return !(*this < iter);
+    }
+
+    /**
+     * Operator *
+     * @return const reference on value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    reference operator*() const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || index >= deque->size)
+          throw exception("Try to use end iterator");
+
+      return *deque->Slot(deque->first + index);
+    }
+
+    /**
+     * Operator ->
+     * @return pointer to value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    pointer operator->() const noexcept(!checkedIterators) {
+      return &**this;
+    }
+
+    /**
+     * Operator []
+     * @param[in] offset offset of the element from current iterator
+     * @return const reference on element
+     * @exception "Try to use end iterator" if the element is out of deque (checked iterators only)
+     */
+    reference operator[](difference_type offset) const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || (offset < 0 && (size_t)-offset > index) || (offset >= 0 && (size_t)offset >= deque->size - index))
+          throw exception("Try to use end iterator");
+
+      return *deque->Slot(deque->first + index + offset);
+    }
+  };
+
+  /**
+   * Method begin for const iterator
+   * @return iterator that corresponds first element
+   */
+  const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+
+  /**
+   * Method end for const iterator
+   * @return iterator that corresponds element after last
+   */
+  const_iterator end() const {
+    return const_iterator(this, size);
+  }
+
+  /**
+   * @brief Block deque reverse iterator
+   *
+   * Allows to iterate in reverse order in deque
+   */
+  class reverse_iterator {
+  private:
+    block_deque_t* deque;   ///< Pointer to the iterated deque
+    size_t index;           ///< Index of the element to which the iterator corresponds (size_t(-1) for rend)
+  public:
+    /**
+     * Default constructor for reverse iterator
+     */
+    reverse_iterator() : deque(nullptr), index(size_t(-1)) {}
+
+    /**
+     * Constructor from deque and element index
+     * @param[in] deque pointer to the iterated deque
+     * @param[in] index index of the element we want to build iterator from
+     */
+    reverse_iterator(block_deque_t* deque, size_t index) : deque(deque), index(index) {}
+
+    /**
+     * Prefix ++ operator
+     * @return reference to next reverse iterator
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    reverse_iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || index >= deque->size)
+          throw exception("Try to use end iterator");
+
+      index--;
+
+      return *this;
+    }
+
+    /**
+     * Postfix ++ operator
+     * @return reference to current reverse iterator
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    reverse_iterator operator++(int) noexcept(!checkedIterators) {
+      reverse_iterator tmp = *this;
+
+      ++*this;
+
+      return tmp;
+    }
+
+    /**
+     * Comparison operator ==
+     * @param[in] iter iterator we want to compare with
+     * @return true if equals, false otherwise
+     */
+    bool operator==(reverse_iterator const& iter) const noexcept {
+      return deque == iter.deque && index == iter.index;
+    }
+
+    /**
+     * Comparison operator !=
+     * @param[in] iter iterator we want to compare with
+     * @return false if equals, true otherwise
+     */
+    bool operator!=(reverse_iterator const& iter) const noexcept {
+      return !(*this == iter);
+    }
+
+    /**
+     * Operator *
+     * @return reference on value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is out of deque (checked iterators only)
+     */
+    elemType& operator*() const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (deque == nullptr || index >= deque->size)
+          throw exception("Try to use end iterator");
+
+      return *deque->Slot(deque->first + index);
+    }
+  };
+
+  /**
+   * Method begin for reverse iterator
+   * @return iterator that corresponds last element
+   */
+  reverse_iterator rbegin() {
+    return reverse_iterator(this, size - 1);
+  }
+
+  /**
+   * Method end for reverse iterator
+   * @return iterator that corresponds element before first
+   */
+  reverse_iterator rend() {
+    return reverse_iterator(this, size_t(-1));
+  }
+
+  /**
+   * Default deque constructor
+   */
+  block_deque_t() : map(nullptr), mapSize(0), first(0), size(0) {};
+
+  /**
+   * Constructor with allocator
+   * @param[in] allocator allocator to be used by deque
+   */
+  explicit block_deque_t(memoryAllocator const& allocator) : holder_t(allocator), map(nullptr), mapSize(0), first(0), size(0) {};
+
+  /**
+   * Deque constructor with initializer list
+   * @param[in] list list of 'elemType' values
+   */
+  block_deque_t(std::initializer_list<elemType> list) : map(nullptr), mapSize(0), first(0), size(0) {
+    PushBackRange(list.begin(), list.end());
+  };
+
+  /**
+   * Copy constructor (storage is prepared at once, trivially copyable elements are copied block by block)
+   * @param[in] deque const reference on deque to copy
+   */
+  block_deque_t(block_deque_t const& deque) : holder_t(deque.Allocator()), map(nullptr), mapSize(0), first(0), size(0) {
+    try {
+      Assign(deque);
+    }
+    catch (...) {
+      ReleaseStorage();
+      throw;
+    }
+  };
+
+  /**
+   * Move constructor
+   * @param[in] deque rvalue reference on deque to move
+   */
+  block_deque_t(block_deque_t&& deque) : holder_t(std::move(deque.Allocator())) {
+    Steal(deque);
+  };
+
+  /**
+   * Copy operator= (existing blocks are reused, the deque is not changed if a constructor or an allocation throws)
+   * @param[in] deque const reference on deque to copy
+   */
+  void operator=(block_deque_t const& deque) {
+    if (this == &deque)
+      return;
+
+    Assign(deque);
+  }
+
+  /**
+   * Move operator=
+   * @param[in] deque rvalue reference on deque to move
+   */
+  void operator=(block_deque_t&& deque) {
+    if (this == &deque)
+      return;
+
+    Clear();
+    ReleaseStorage();
+    Allocator() = std::move(deque.Allocator());
+    Steal(deque);
+  }
+
+  /**
+   * Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  bool IsEmpty() const {
+    return size == 0;
+  }
+
+  /**
+   * Get deque size method
+   * @return number of elements in the deque
+   */
+  size_t Size() const {
+    return size;
+  }
+
+  /**
+   * Method to see what first element is
+   * @returns const reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType const& PeekHead() const {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    return *Slot(first);
+  }
+
+  /**
+   * Method to get first element
+   * @returns reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& GetFront() {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    return *Slot(first);
+  }
+
+  /**
+   * Method to see what last element is
+   * @returns const reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType const& PeekTail() const {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    return *Slot(first + size - 1);
+  }
+
+  /**
+   * Method to get last element
+   * @returns reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& GetBack() {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    return *Slot(first + size - 1);
+  }
+
+  /**
+   * Method to see what first element is without throwing on empty deque
+   * @returns pointer to first element or nullptr if deque is empty
+   */
+  elemType const* TryPeekHead() const noexcept {
+    return size ? Slot(first) : nullptr;
+  }
+
+  /**
+   * Method to see what last element is without throwing on empty deque
+   * @returns pointer to last element or nullptr if deque is empty
+   */
+  elemType const* TryPeekTail() const noexcept {
+    return size ? Slot(first + size - 1) : nullptr;
+  }
+
+  /**
+   * Operator [] (index is not checked)
+   * @param[in] index index of the element counted from the first one
+   * @returns reference on element
+   */
+  elemType& operator[](size_t index) noexcept {
+    return *Slot(first + index);
+  }
+
+  /**
+   * Operator [] for const deque (index is not checked)
+   * @param[in] index index of the element counted from the first one
+   * @returns const reference on element
+   */
+  elemType const& operator[](size_t index) const noexcept {
+    return *Slot(first + index);
+  }
+
+  /**
+   * Method to get element by index
+   * @param[in] index index of the element counted from the first one
+   * @returns reference on element
+   * @exception "Index is out of range" if there is no element with such index
+   */
+  elemType& At(size_t index) {
+    if (index >= size)
+      throw exception("Index is out of range");
+
+    return *Slot(first + index);
+  }
+
+  /**
+   * Method to get element of const deque by index
+   * @param[in] index index of the element counted from the first one
+   * @returns const reference on element
+   * @exception "Index is out of range" if there is no element with such index
+   */
+  elemType const& At(size_t index) const {
+    if (index >= size)
+      throw exception("Index is out of range");
+
+    return *Slot(first + index);
+  }
+
+  /**
+   * Method to construct element in place at begin of deque
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @returns reference on constructed element
+   */
+  template <typename... args>
+  elemType& EmplaceFront(args&&... params) {
+    if (first == 0)
+      GrowMap();
+
+    elemType* elem = new ((void*)AcquireSlot(first - 1)) elemType(std::forward<args>(params)...);
+
+    first--;
+    size++;
+
+    return *elem;
+  }
+
+  /**
+   * Method to construct element in place at end of deque
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @returns reference on constructed element
+   */
+  template <typename... args>
+  elemType& EmplaceBack(args&&... params) {
+    if (first + size == mapSize * blockSize)
+      GrowMap();
+
+    elemType* elem = new ((void*)AcquireSlot(first + size)) elemType(std::forward<args>(params)...);
+
+    size++;
+
+    return *elem;
+  }
+
+  /**
+   * Method put element to begin of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushFront(elemType const& elem) {
+    EmplaceFront(elem);
+  }
+
+  /**
+   * Method put element to begin of deque (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushFront(elemType&& elem) {
+    EmplaceFront(std::move(elem));
+  }
+
+  /**
+   * Method put element to end of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushBack(elemType const& elem) {
+    EmplaceBack(elem);
+  }
+
+  /**
+   * Method put element to end of deque (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushBack(elemType&& elem) {
+    EmplaceBack(std::move(elem));
+  }
+
+  /**
+   * Method put range of elements to end of deque
+   *
+   * Map and blocks for the whole range are prepared at once if the range size is known;
+   * if an element constructor throws, the deque is not changed
+   * @tparam inputIter type of range iterator
+   * @param[in] from iterator to the first element of range
+   * @param[in] to iterator to the element after the last one
+   * @returns refernece on current deque
+   */
+  template <typename inputIter>
+  block_deque_t& PushBackRange(inputIter from, inputIter to) {
+    size_t added = 0;
+
+    if constexpr (std::forward_iterator<inputIter>)
+      ReserveBack((size_t)std::distance(from, to));
+
+    try {
+      for (; from != to; ++from, added++)
+        EmplaceBack(*from);
+    }
+    catch (...) {
+      while (added--)
+        PopBack();
+
+      throw;
+    }
+
+    return *this;
+  }
+
+  /**
+   * Method put range of elements to end of deque
+   * @tparam range type of range (container, span, etc.)
+   * @param[in] elems range of elements
+   * @returns refernece on current deque
+   */
+  template <std::ranges::input_range range> requires std::ranges::common_range<range>
+  block_deque_t& PushBackRange(range&& elems) {
+    return PushBackRange(std::ranges::begin(elems), std::ranges::end(elems));
+  }
+
+  /**
+   * Method put range of elements to begin of deque (the first element of range becomes the first element of deque)
+   *
+   * Map and blocks for the whole range are prepared at once if the range size is known;
+   * if an element constructor throws, the deque is not changed
+   * @tparam inputIter type of range iterator
+   * @param[in] from iterator to the first element of range
+   * @param[in] to iterator to the element after the last one
+   * @returns refernece on current deque
+   */
+  template <typename inputIter>
+  block_deque_t& PushFrontRange(inputIter from, inputIter to) {
+    if constexpr (std::forward_iterator<inputIter>) {
+      size_t count = (size_t)std::distance(from, to), built = 0;
+
+      ReserveFront(count);
+
+      size_t start = first - count;
+
+      try {
+        for (; from != to; ++from, built++)
+          new ((void*)AcquireSlot(start + built)) elemType(*from);
+      }
+      catch (...) {
+        while (built--)
+          Slot(start + built)->~elemType();
+
+        throw;
+      }
+
+      first = start;
+      size += count;
+    }
+    else {
+      block_deque_t tmp;
+      size_t added = 0;
+
+      tmp.PushBackRange(from, to);
+
+      try {
+        for (; added < tmp.size; added++)
+          EmplaceFront(std::move(*tmp.Slot(tmp.first + tmp.size - 1 - added)));
+      }
+      catch (...) {
+        while (added--)
+          PopFront();
+
+        throw;
+      }
+    }
+
+    return *this;
+  }
+
+  /**
+   * Method put range of elements to begin of deque (the first element of range becomes the first element of deque)
+   * @tparam range type of range (container, span, etc.)
+   * @param[in] elems range of elements
+   * @returns refernece on current deque
+   */
+  template <std::ranges::input_range range> requires std::ranges::common_range<range>
+  block_deque_t& PushFrontRange(range&& elems) {
+    return PushFrontRange(std::ranges::begin(elems), std::ranges::end(elems));
+  }
+
+  /**
+   * Method to remove first element from deque
+   * @exception "Deque is empty" if deque is empty
+   */
+  void PopFront() {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    Slot(first)->~elemType();
+    first++;
+    size--;
+
+    if (size == 0)
+      Recenter();
+  }
+
+  /**
+   * Method to remove last element from deque
+   * @exception "Deque is empty" if deque is empty
+   */
+  void PopBack() {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    Slot(first + size - 1)->~elemType();
+    size--;
+
+    if (size == 0)
+      Recenter();
+  }
+
+  /**
+   * Method to take first element from deque without throwing on empty deque
+   * @returns moved first element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopFront() {
+    if (size == 0)
+      return std::nullopt;
+
+    std::optional<elemType> result(std::move(*Slot(first)));
+
+    PopFront();
+
+    return result;
+  }
+
+  /**
+   * Method to take last element from deque without throwing on empty deque
+   * @returns moved last element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopBack() {
+    if (size == 0)
+      return std::nullopt;
+
+    std::optional<elemType> result(std::move(*Slot(first + size - 1)));
+
+    PopBack();
+
+    return result;
+  }
+
+  /**
+   * Method to move up to 'count' first elements out of deque
+   *
+   * Elements are moved to the output in direct order and removed without emptiness checks per element
+   * @tparam outputIter type of output iterator
+   * @param[in] count maximum number of elements to remove
+   * @param[in] out output iterator to move elements to
+   * @returns output iterator after the last written element
+   */
+  template <typename outputIter>
+  outputIter PopFrontN(size_t count, outputIter out) {
+    for (; count > 0 && size > 0; count--) {
+      elemType* elem = Slot(first);
+
+      *out = std::move(*elem);
+      ++out;
+      elem->~elemType();
+      first++;
+      size--;
+    }
+
+    if (size == 0)
+      Recenter();
+
+    return out;
+  }
+
+  /**
+   * Method to move up to 'count' last elements out of deque
+   *
+   * Elements are moved to the output in reverse order and removed without emptiness checks per element
+   * @tparam outputIter type of output iterator
+   * @param[in] count maximum number of elements to remove
+   * @param[in] out output iterator to move elements to
+   * @returns output iterator after the last written element
+   */
+  template <typename outputIter>
+  outputIter PopBackN(size_t count, outputIter out) {
+    for (; count > 0 && size > 0; count--) {
+      elemType* elem = Slot(first + size - 1);
+
+      *out = std::move(*elem);
+      ++out;
+      elem->~elemType();
+      size--;
+    }
+
+    if (size == 0)
+      Recenter();
+
+    return out;
+  }
+
+  /**
+   * Method to move all elements out of deque in direct order
+   * @tparam outputIter type of output iterator
+   * @param[in] out output iterator to move elements to
+   * @returns output iterator after the last written element
+   */
+  template <typename outputIter>
+  outputIter DrainTo(outputIter out) {
+    return PopFrontN(size, out);
+  }
+
+  /**
+   * Method to move all elements out of deque in reverse order
+   * @tparam outputIter type of output iterator
+   * @param[in] out output iterator to move elements to
+   * @returns output iterator after the last written element
+   */
+  template <typename outputIter>
+  outputIter DrainBackTo(outputIter out) {
+    return PopBackN(size, out);
+  }
+
+  /**
+   * Method for adding elements of another deque to the end of the current one (copy semantics)
+   * @param[in] deque const reference on other deque
+   * @returns refernece on current deque
+   */
+  block_deque_t& AddOtherDeque(block_deque_t const& deque) {
+    size_t count = deque.size;
+
+    ReserveBack(count);
+    for (size_t i = 0; i < count; i++)
+      PushBack(*deque.Slot(deque.first + i));
+
+    return *this;
+  }
+
+  /**
+   * Method for adding elements of another deque to the end of the current one (move semantics)
+   * @param[in] deque rvalue reference on other deque
+   * @returns refernece on current deque
+   */
+  block_deque_t& AddOtherDeque(block_deque_t&& deque) {
+    if (this == &deque)
+      return *this;
+
+    if (size == 0) {
+      ReleaseStorage();
+      Allocator() = std::move(deque.Allocator());
+      Steal(deque);
+    }
+    else {
+      for (auto& d : deque)
+        PushBack(std::move(d));
+
+      deque.Clear();
+    }
+
+    return *this;
+  }
+
+  /**
+   * Method to pre-allocate blocks, so that 'front' elements can be put to begin and 'back' elements to end without allocation
+   * @param[in] front number of elements expected to be put to begin of deque
+   * @param[in] back number of elements expected to be put to end of deque
+   * @warning if the deque becomes empty, its first position moves to the middle of the map and the reserved blocks may not be where the next pushes go
+   */
+  void Reserve(size_t front, size_t back) {
+    if (front > first || first + size + back > mapSize * blockSize)
+      GrowMap((front + blockSize - 1) / blockSize + 1, (back + blockSize - 1) / blockSize + 1);
+
+    size_t from = (first - front) / blockSize, to = (first + size + back + blockSize - 1) / blockSize;
+
+    for (size_t b = from; b < to; b++)
+      AcquireSlot(b * blockSize);
+  }
+
+  /**
+   * Method to free blocks without elements and shrink the map to the used blocks
+   */
+  void ShrinkToFit() {
+    if (size == 0) {
+      ReleaseStorage();
+      return;
+    }
+
+    size_t firstBlock = first / blockSize, lastBlock = (first + size - 1) / blockSize;
+    size_t usedBlocks = lastBlock - firstBlock + 1;
+
+    for (size_t i = 0; i < mapSize; i++)
+      if (map[i] && (i < firstBlock || i > lastBlock)) {
+        DeallocAligned<alignof(elemType)>(Allocator(), (void*)map[i]);
+        map[i] = nullptr;
+      }
+
+    size_t newMapSize = std::max(initialMapSize, 2 * (usedBlocks + 2));
+
+    if (newMapSize >= mapSize)
+      return;
+
+    elemType** newMap = AllocMap(newMapSize);
+    size_t newFirstBlock = (newMapSize - usedBlocks) / 2;
+
+    std::fill(newMap, newMap + newMapSize, nullptr);
+    std::copy(map + firstBlock, map + lastBlock + 1, newMap + newFirstBlock);
+    DeallocMap(map);
+
+    map = newMap;
+    mapSize = newMapSize;
+    first = newFirstBlock * blockSize + first % blockSize;
+  }
+
+  /**
+   * Get deque capacity method
+   * @return number of element slots in allocated blocks
+   */
+  size_t Capacity() const noexcept {
+    size_t blocks = 0;
+
+    for (size_t i = 0; i < mapSize; i++)
+      blocks += map[i] != nullptr;
+
+    return blocks * blockSize;
+  }
+
+  /**
+   * Method to call function for every element in parallel
+   *
+   * Elements are split into contiguous segments on block boundaries, each segment is processed by its own thread
+   * @tparam func type of function called as func(elemType&), must be safe to call for different elements at once
+   * @param[in] f function to call
+   * @param[in] threadCount maximum number of threads (0 to use all hardware threads)
+   */
+  template <typename func>
+  void ForEach(func const& f, unsigned threadCount = 0) {
+    size_t segments = SegmentCount(threadCount);
+
+    RunParallelSegments(segments, [&](size_t segment) {
+      ForEachPiece(segment, segments, [&](elemType* from, elemType* to) {
+        for (; from != to; ++from)
+          f(*from);
+      });
+    });
+  }
+
+  /**
+   * Method to call function for every element with execution policy
+   * @tparam policy type of execution policy (sequenced policy runs in the calling thread)
+   * @tparam func type of function called as func(elemType&)
+   * @param[in] f function to call
+   */
+  template <typename policy, typename func> requires std::is_execution_policy_v<std::remove_cvref_t<policy>>
+  void ForEach(policy&&, func const& f) {
+    ForEach(f, PolicyThreadCount<policy>());
+  }
+
+  /**
+   * Method to replace every element by the result of function in parallel
+   * @tparam func type of function called as func(elemType const&), must be safe to call for different elements at once
+   * @param[in] f function to call
+   * @param[in] threadCount maximum number of threads (0 to use all hardware threads)
+   */
+  template <typename func>
+  void Transform(func const& f, unsigned threadCount = 0) {
+    ForEach([&](elemType& elem) { elem = f(std::as_const(elem)); }, threadCount);
+  }
+
+  /**
+   * Method to replace every element by the result of function with execution policy
+   * @tparam policy type of execution policy (sequenced policy runs in the calling thread)
+   * @tparam func type of function called as func(elemType const&)
+   * @param[in] f function to call
+   */
+  template <typename policy, typename func> requires std::is_execution_policy_v<std::remove_cvref_t<policy>>
+  void Transform(policy&&, func const& f) {
+    Transform(f, PolicyThreadCount<policy>());
+  }
+
+  /**
+   * Method to reduce elements in parallel
+   *
+   * Every segment is reduced by its own thread, then partial results are combined with 'init' in segment order
+   * @tparam type type of result (constructible from elemType)
+   * @tparam binaryOp type of associative operation called as op(type, elemType const&) and op(type, type)
+   * @param[in] init initial value
+   * @param[in] op operation
+   * @param[in] threadCount maximum number of threads (0 to use all hardware threads)
+   * @return reduced value ('init' if deque is empty)
+   */
+  template <typename type, typename binaryOp>
+  type Reduce(type init, binaryOp const& op, unsigned threadCount = 0) const {
+    size_t segments = SegmentCount(threadCount);
+    std::vector<std::optional<type>> partials(segments);
+
+    RunParallelSegments(segments, [&](size_t segment) {
+      std::optional<type> acc;
+
+      ForEachPiece(segment, segments, [&](elemType const* from, elemType const* to) {
+        if (!acc)
+          acc.emplace(*from++);
+        for (; from != to; ++from)
+          acc = op(std::move(*acc), *from);
+      });
+      partials[segment] = std::move(acc);
+    });
+
+    for (auto& p : partials)
+      init = op(std::move(init), std::move(*p));
+
+    return init;
+  }
+
+  /**
+   * Method to reduce elements with execution policy
+   * @tparam policy type of execution policy (sequenced policy runs in the calling thread)
+   * @tparam type type of result (constructible from elemType)
+   * @tparam binaryOp type of associative operation
+   * @param[in] init initial value
+   * @param[in] op operation
+   * @return reduced value ('init' if deque is empty)
+   */
+  template <typename policy, typename type, typename binaryOp> requires std::is_execution_policy_v<std::remove_cvref_t<policy>>
+  type Reduce(policy&&, type init, binaryOp const& op) const {
+    return Reduce(std::move(init), op, PolicyThreadCount<policy>());
+  }
+
+  /**
+   * Method to sum elements with vectorized kernel over every block
+   * @return sum of elements (64-bit for integral types, 0 if deque is empty)
+   * @see SimdSum
+   */
+  simd_sum_t<elemType> Sum() const requires std::is_arithmetic_v<elemType> {
+    simd_sum_t<elemType> sum = 0;
+
+    if (size)
+      ForEachPiece(0, 1, [&](elemType const* from, elemType const* to) { sum += SimdSum(from, (size_t)(to - from)); });
+
+    return sum;
+  }
+
+  /**
+   * Method to find minimal element with vectorized kernel over every block
+   * @return minimal element
+   * @exception "Deque is empty" if deque is empty
+   * @see SimdMin
+   */
+  elemType Min() const requires std::is_arithmetic_v<elemType> {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    elemType result = *Slot(first);
+
+    ForEachPiece(0, 1, [&](elemType const* from, elemType const* to) {
+      elemType piece = SimdMin(from, (size_t)(to - from));
+
+      result = piece < result ? piece : result;
+    });
+
+    return result;
+  }
+
+  /**
+   * Method to find maximal element with vectorized kernel over every block
+   * @return maximal element
+   * @exception "Deque is empty" if deque is empty
+   * @see SimdMax
+   */
+  elemType Max() const requires std::is_arithmetic_v<elemType> {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    elemType result = *Slot(first);
+
+    ForEachPiece(0, 1, [&](elemType const* from, elemType const* to) {
+      elemType piece = SimdMax(from, (size_t)(to - from));
+
+      result = result < piece ? piece : result;
+    });
+
+    return result;
+  }
+
+  /**
+   * Method to find value with vectorized kernel over every block
+   * @param[in] value value to find
+   * @return index of the first element equal to value (Size() if there is no such element)
+   * @see SimdFind
+   */
+  size_t Find(elemType value) const requires std::is_arithmetic_v<elemType> {
+    for (size_t pos = first, end = first + size; pos < end;) {
+      size_t pieceEnd = std::min(end, (pos / blockSize + 1) * blockSize);
+      size_t found = SimdFind(Slot(pos), pieceEnd - pos, value);
+
+      if (found != pieceEnd - pos)
+        return pos - first + found;
+
+      pos = pieceEnd;
+    }
+
+    return size;
+  }
+
+  /**
+   * Method to count value with vectorized kernel over every block
+   * @param[in] value value to count
+   * @return number of elements equal to value
+   * @see SimdCount
+   */
+  size_t Count(elemType value) const requires std::is_arithmetic_v<elemType> {
+    size_t count = 0;
+
+    if (size)
+      ForEachPiece(0, 1, [&](elemType const* from, elemType const* to) { count += SimdCount(from, (size_t)(to - from), value); });
+
+    return count;
+  }
+
+  /**
+   * Method to assign value to every element with vectorized kernel over every block
+   * @param[in] value value to assign
+   * @see SimdFill
+   */
+  void Fill(elemType value) requires std::is_arithmetic_v<elemType> {
+    if (size)
+      ForEachPiece(0, 1, [&](elemType* from, elemType* to) { SimdFill(from, (size_t)(to - from), value); });
+  }
+
+  /**
+   * Write elements to stream through a buffer without flushing the stream (elements are read block by block)
+   * @param[in] stream output stream
+   * @param[in] separator string written after every element
+   * @return reference to stream
+   */
+  std::ostream& WriteTo(std::ostream& stream, std::string_view separator = " ") const {
+    stream_writer_t writer(stream);
+
+    if (size)
+      ForEachPiece(0, 1, [&](elemType const* from, elemType const* to) {
+        for (; from != to; ++from) {
+          writer.Put(*from);
+          writer.Write(separator);
+        }
+      });
+
+    writer.Flush();
+
+    return stream;
+  }
+
+  /**
+   * Write elements to stream in binary snapshot format (header followed by raw elements, written block by block)
+   * @param[in] stream output binary stream
+   * @exception "Failed to write snapshot" if the stream fails
+   * @see snapshot_header_t
+   */
+  void Serialize(std::ostream& stream) const requires std::is_trivially_copyable_v<elemType> {
+    snapshot_header_t header = MakeSnapshotHeader(sizeof(elemType), size);
+
+    stream.write((char const*)&header, sizeof(header));
+
+    if (size)
+      ForEachPiece(0, 1, [&](elemType const* from, elemType const* to) {
+        stream.write((char const*)from, (std::streamsize)((to - from) * sizeof(elemType)));
+      });
+
+    if (!stream)
+      throw exception("Failed to write snapshot");
+  }
+
+  /**
+   * Replace elements with elements read from stream in binary snapshot format
+   *
+   * Elements are read straight into blocks after the current ones, and storage grows block by block as data arrives,
+   * so the count in the header is never trusted for allocation. If reading fails, the deque is not changed
+   * @param[in] stream input binary stream
+   * @exception "Snapshot is truncated" if the stream ends before the snapshot does
+   * @exception "Block deque is out of memory" if storage for the elements cannot be allocated
+   * @see CheckSnapshotHeader
+   */
+  void Deserialize(std::istream& stream) requires std::is_trivially_copyable_v<elemType> {
+    uint64_t count = ReadSnapshotHeader(stream, sizeof(elemType));
+    size_t kept = size;
+
+    try {
+      for (uint64_t loaded = 0; loaded < count; ) {
+        size_t n = (size_t)std::min<uint64_t>(count - loaded, blockSize - (first + size) % blockSize);
+
+        ReserveBack(n);
+
+        elemType* slot = AcquireSlot(first + size);
+
+        if (!stream.read((char*)slot, (std::streamsize)(n * sizeof(elemType))))
+          throw exception("Snapshot is truncated");
+
+        size += n;
+        loaded += n;
+      }
+    }
+    catch (...) {
+      size = kept;   // read elements are trivially destructible, their blocks stay for further use
+
+      if (size == 0)
+        Recenter();
+      throw;
+    }
+
+    first += kept;
+    size -= kept;
+
+    if (size == 0)
+      Recenter();
+  }
+
+  /**
+   * Clear deque (allocated blocks are kept for further use)
+   */
+  void Clear(void) {
+    DestroyElements();
+    size = 0;
+    Recenter();
+  }
+
+  /**
+   * Deque destructor
+   */
+  ~block_deque_t() {
+    DestroyElements();
+    ReleaseStorage();
+  }
+};
+
+/**
+ * Operator<< for block deque (elements are separated by spaces and followed by a new line, the stream is not flushed)
+ * @tparam type type of deque elements
+ * @tparam memoryAllocator the allocator used by deque
+ * @tparam blockSize number of elements in one block
+ * @param[in] stream output stream
+ * @param[in] deque deque to output
+ * @return reference to stream
+ */
+template <typename type, typename memoryAllocator, size_t blockSize>
+std::ostream& operator<<(std::ostream& stream, block_deque_t<type, memoryAllocator, blockSize> const& deque) {
+  return deque.WriteTo(stream) << '\n';
+}
@@ -0,0 +1,925 @@
+#pragma once
+
+#include <exception>
+#include <iterator>
+#include <ostream>
+#include <string_view>
+#include <optional>
+#include <type_traits>
+#include <initializer_list>
+#include <new>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "allocator.h"
+#include "iterator_policy.h"
+#include "stream_writer.h"
+
+using std::exception;
+
+/**
+ * @brief Compact deque class
+ *
+ * Doubly-linked deque whose nodes live in a slot pool owned by the deque: slots are carved from chunks of 'chunkSlots' nodes
+ * and linked by 32-bit slot indices instead of pointers, with the links placed before the value to keep padding minimal
+ * (a node of int takes 12 bytes instead of 24). Removed slots go to a free list and are reused, chunks are never moved,
+ * so references to elements stay valid until the element is removed
+ * @tparam elemType type of stored elements
+ * @tparam memoryAllocator the allocator chunks are taken from (allocator based on malloc/free is used by default);
+ * the chunk table is taken from it too unless it serves one slot size only (pool_allocator_t)
+ * @tparam chunkSlots number of slots in one chunk (a power of two)
+ * @warning a deque holds at most 2^32 - chunkSlots elements
+ * @see deque_t
+ */
+template <typename elemType, deque_allocator memoryAllocator = simple_allocator_t, size_t chunkSlots = 1024>
+class compact_deque_t : private allocator_holder_t<memoryAllocator> {
+private:
+  static_assert(chunkSlots > 0 && (chunkSlots & (chunkSlots - 1)) == 0, "Number of slots in a chunk must be a power of two");
+
+  using holder_t = allocator_holder_t<memoryAllocator>;
+  using holder_t::Allocator;
+
+  static constexpr uint32_t nil = UINT32_MAX;                 ///< index of no slot
+  static constexpr size_t maxChunks = nil / chunkSlots;       ///< number of chunks whose slot indices are below 'nil'
+  static constexpr size_t initialTableSize = 8;               ///< number of chunk pointers in the first chunk table
+  static constexpr bool separateTable = fixed_slot_allocator<memoryAllocator>;   ///< true if the chunk table is allocated by malloc
+
+  /**
+   * @brief Compact deque node struct
+   *
+   * Slot of the pool: links first, then the value storage (constructed only while the slot is used)
+   */
+  struct node_t {
+    uint32_t prev;                                            ///< index of previous node (nil if the node is the first one)
+    uint32_t next;                                            ///< index of next node (nil if the node is the last one or the slot is free)
+    alignas(elemType) unsigned char storage[sizeof(elemType)];  ///< storage of the value
+
+    /**
+     * Get stored value
+     * @return reference on value
+     */
+    elemType& Value() noexcept {
+      return *std::launder((elemType*)storage);
+    }
+
+    /**
+     * Get stored value
+     * @return const reference on value
+     */
+    elemType const& Value() const noexcept {
+      return *std::launder((elemType const*)storage);
+    }
+  };
+
+  node_t** chunks;            ///< table of chunks (nullptr if nothing is allocated)
+  size_t chunkCount;          ///< number of allocated chunks
+  size_t tableSize;           ///< number of entries in the chunk table
+  uint32_t head;              ///< index of the first node (nil if the deque is empty)
+  uint32_t tail;              ///< index of the last node (nil if the deque is empty)
+  uint32_t freeHead;          ///< first slot of the free list linked by 'next' (nil if there are no free slots)
+  size_t size;                ///< number of elements in the deque
+
+  /**
+   * Get node by slot index
+   * @param[in] index slot index
+   * @return reference on node
+   */
+  node_t& Node(uint32_t index) const noexcept {
+    return chunks[index / chunkSlots][index % chunkSlots];
+  }
+
+  /**
+   * Allocate chunk table
+   *
+   * Slot allocators (pool_allocator_t) serve requests of one size only, so with them chunks come from the allocator
+   * and the table, whose size changes, comes from simple_allocator_t
+   * @param[in] entries number of table entries
+   * @return pointer to allocated table (entries are not initialized)
+   */
+  node_t** AllocTable(size_t entries) {
+    if constexpr (separateTable)
+      return (node_t**)simple_allocator_t().alloc(entries * sizeof(node_t*));
+    else
+      return (node_t**)Allocator().alloc(entries * sizeof(node_t*));
+  }
+
+  /**
+   * Deallocate chunk table
+   * @param[in] data pointer to table allocated by AllocTable
+   */
+  void DeallocTable(node_t** data) noexcept {
+    if constexpr (separateTable)
+      simple_allocator_t().dealloc((void*)data);
+    else
+      Allocator().dealloc((void*)data);
+  }
+
+  /**
+   * Allocate a new chunk and put its slots into the free list
+   * @exception "Deque is full" if no more slot indices are left
+   */
+  void AddChunk() {
+    if (chunkCount == maxChunks)
+      throw exception("Deque is full");
+
+    if (chunkCount == tableSize) {
+      size_t newTableSize = tableSize ? 2 * tableSize : initialTableSize;
+      node_t** newChunks = AllocTable(newTableSize);
+
+      std::copy(chunks, chunks + chunkCount, newChunks);
+
+      if (chunks)
+        DeallocTable(chunks);
+
+      chunks = newChunks;
+      tableSize = newTableSize;
+    }
+
+    node_t* chunk = (node_t*)AllocAligned<alignof(node_t)>(Allocator(), chunkSlots * sizeof(node_t));
+    uint32_t base = (uint32_t)(chunkCount * chunkSlots);
+
+    chunks[chunkCount++] = chunk;
+
+    for (size_t i = chunkSlots; i-- > 0;) {
+      chunk[i].next = freeHead;
+      freeHead = base + (uint32_t)i;
+    }
+  }
+
+  /**
+   * Take a slot from the free list (a chunk is added if the list is empty)
+   * @return slot index
+   * @exception "Deque is full" if no more slot indices are left
+   */
+  uint32_t TakeSlot() {
+    if (freeHead == nil)
+      AddChunk();
+
+    uint32_t index = freeHead;
+
+    freeHead = Node(index).next;
+
+    return index;
+  }
+
+  /**
+   * Put slot to the free list
+   * @param[in] index slot index
+   */
+  void ReleaseSlot(uint32_t index) noexcept {
+    Node(index).next = freeHead;
+    freeHead = index;
+  }
+
+  /**
+   * Free all chunks and the chunk table (the deque must be empty)
+   */
+  void ReleaseChunks() noexcept {
+    if constexpr (!bulk_release_allocator<memoryAllocator> || separateTable) {
+      if constexpr (!bulk_release_allocator<memoryAllocator>)
+        for (size_t i = 0; i < chunkCount; i++)
+          DeallocAligned<alignof(node_t)>(Allocator(), (void*)chunks[i]);
+
+      if (chunks)
+        DeallocTable(chunks);
+    }
+
+    chunks = nullptr;
+    chunkCount = 0;
+    tableSize = 0;
+    freeHead = nil;
+  }
+
+  /**
+   * Take all storage of other deque (this deque must have no storage)
+   * @param[in] deque deque to take storage from (left empty without storage)
+   */
+  void Steal(compact_deque_t& deque) noexcept {
+    chunks = deque.chunks;
+    chunkCount = deque.chunkCount;
+    tableSize = deque.tableSize;
+    head = deque.head;
+    tail = deque.tail;
+    freeHead = deque.freeHead;
+    size = deque.size;
+
+    deque.chunks = nullptr;
+    deque.chunkCount = 0;
+    deque.tableSize = 0;
+    deque.head = nil;
+    deque.tail = nil;
+    deque.freeHead = nil;
+    deque.size = 0;
+  }
+public:
+  /**
+   * @brief Compact deque iterator
+   *
+   * Allows to iterate in direct order in deque
+   */
+  class iterator {
+  private:
+    compact_deque_t* deque;   ///< Deque the iterator belongs to
+    uint32_t cur;             ///< Index of the node to which the iterator corresponds (nil for end)
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;   ///< iterator category for standard algorithms
+    using value_type = elemType;                                 ///< type of elements
+    using difference_type = ptrdiff_t;                           ///< type of distance between iterators
+    using pointer = elemType*;                                   ///< pointer to element
+    using reference = elemType&;                                 ///< reference on element
+
+    /**
+     * Default constructor for iterator
+     */
+    iterator() : deque(nullptr), cur(nil) {}
+
+    /**
+     * Constructor from deque and slot index
+     * @param[in] deque deque the iterator belongs to
+     * @param[in] cur index of the node we want to build iterator from (nil for end)
+     */
+    iterator(compact_deque_t* deque, uint32_t cur) : deque(deque), cur(cur) {}
+
+    /**
+     * Prefix ++ operator
+     * @return reference to next iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (cur == nil)
+          throw exception("Try to use end iterator");
+
+      cur = deque->Node(cur).next;
+
+      return *this;
+    }
+
+    /**
+     * Postfix ++ operator
+     * @return reference to current iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    iterator operator++(int) noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      ++*this;
+
+      return tmp;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to previous iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    iterator& operator--() noexcept(!checkedIterators) {
+      uint32_t prev = cur == nil ? deque->tail : deque->Node(cur).prev;
+
+      if constexpr (checkedIterators)
+        if (prev == nil)
+          throw exception("Iterator is out of range");
+
+      cur = prev;
+
+      return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    iterator operator--(int) noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      --*this;
+
+      return tmp;
+    }
+
+    /**
+     * Comparison operator ==
+     * @param[in] iter iterator we want to compare with
+     * @return true if equals, false otherwise
+     */
+    bool operator==(iterator const& iter) const noexcept {
+      return cur == iter.cur;
+    }
+
+    /**
+     * Operator *
+     * @return reference on value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType& operator*() const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (cur == nil)
+          throw exception("Try to use end iterator");
+
+      return deque->Node(cur).Value();
+    }
+
+    /**
+     * Operator ->
+     * @return pointer to value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType* operator->() const noexcept(!checkedIterators) {
+      return &**this;
+    }
+  };
+
+  /**
+   * @brief Compact deque const iterator
+   *
+   * Allows to iterate in direct order in const deque
+   */
+  class const_iterator {
+  private:
+    compact_deque_t const* deque;   ///< Deque the iterator belongs to
+    uint32_t cur;                   ///< Index of the node to which the iterator corresponds (nil for end)
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;   ///< iterator category for standard algorithms
+    using value_type = elemType;                                 ///< type of elements
+    using difference_type = ptrdiff_t;                           ///< type of distance between iterators
+    using pointer = elemType const*;                             ///< pointer to element
+    using reference = elemType const&;                           ///< reference on element
+
+    /**
+     * Default constructor for iterator
+     */
+    const_iterator() : deque(nullptr), cur(nil) {}
+
+    /**
+     * Constructor from deque and slot index
+     * @param[in] deque deque the iterator belongs to
+     * @param[in] cur index of the node we want to build iterator from (nil for end)
+     */
+    const_iterator(compact_deque_t const* deque, uint32_t cur) : deque(deque), cur(cur) {}
+
+    /**
+     * Prefix ++ operator
+     * @return reference to next iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    const_iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (cur == nil)
+          throw exception("Try to use end iterator");
+
+      cur = deque->Node(cur).next;
+
+      return *this;
+    }
+
+    /**
+     * Postfix ++ operator
+     * @return reference to current iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    const_iterator operator++(int) noexcept(!checkedIterators) {
+      const_iterator tmp = *this;
+
+      ++*this;
+
+      return tmp;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to previous iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    const_iterator& operator--() noexcept(!checkedIterators) {
+      uint32_t prev = cur == nil ? deque->tail : deque->Node(cur).prev;
+
+      if constexpr (checkedIterators)
+        if (prev == nil)
+          throw exception("Iterator is out of range");
+
+      cur = prev;
+
+      return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    const_iterator operator--(int) noexcept(!checkedIterators) {
+      const_iterator tmp = *this;
+
+      --*this;
+
+      return tmp;
+    }
+
+    /**
+     * Comparison operator ==
+     * @param[in] iter iterator we want to compare with
+     * @return true if equals, false otherwise
+     */
+    bool operator==(const_iterator const& iter) const noexcept {
+      return cur == iter.cur;
+    }
+
+    /**
+     * Operator *
+     * @return const reference on value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType const& operator*() const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (cur == nil)
+          throw exception("Try to use end iterator");
+
+      return deque->Node(cur).Value();
+    }
+
+    /**
+     * Operator ->
+     * @return const pointer to value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType const* operator->() const noexcept(!checkedIterators) {
+      return &**this;
+    }
+  };
+
+  /**
+   * Method begin for iterator
+   * @return iterator that corresponds first element
+   */
+  iterator begin() noexcept {
+    return iterator(this, head);
+  }
+
+  /**
+   * Method end for iterator
+   * @return iterator that corresponds element after last
+   */
+  iterator end() noexcept {
+    return iterator(this, nil);
+  }
+
+  /**
+   * Method begin for const iterator
+   * @return const iterator that corresponds first element
+   */
+  const_iterator begin() const noexcept {
+    return const_iterator(this, head);
+  }
+
+  /**
+   * Method end for const iterator
+   * @return const iterator that corresponds element after last
+   */
+  const_iterator end() const noexcept {
+    return const_iterator(this, nil);
+  }
+
+  /**
+   * Default deque constructor
+   */
+  compact_deque_t() : chunks(nullptr), chunkCount(0), tableSize(0), head(nil), tail(nil), freeHead(nil), size(0) {}
+
+  /**
+   * Constructor with allocator
+   * @param[in] allocator allocator to be used by deque
+   */
+  explicit compact_deque_t(memoryAllocator const& allocator) :
+    holder_t(allocator), chunks(nullptr), chunkCount(0), tableSize(0), head(nil), tail(nil), freeHead(nil), size(0) {}
+
+  /**
+   * Constructor from initializer list
+   * @param[in] list list of elements
+   */
+  compact_deque_t(std::initializer_list<elemType> list) : compact_deque_t() {
+    try {
+      for (elemType const& elem : list)
+        PushBack(elem);
+    }
+    catch (...) {
+      Clear();
+      ReleaseChunks();
+      throw;
+    }
+  }
+
+  /**
+   * Copy constructor
+   * @param[in] deque const reference on deque to copy
+   */
+  compact_deque_t(compact_deque_t const& deque) : compact_deque_t(deque.Allocator()) {
+    try {
+      Reserve(deque.size, 0);
+      for (elemType const& elem : deque)
+        PushBack(elem);
+    }
+    catch (...) {
+      Clear();
+      ReleaseChunks();
+      throw;
+    }
+  }
+
+  /**
+   * Move constructor
+   * @param[in] deque rvalue reference on deque to move
+   */
+  compact_deque_t(compact_deque_t&& deque) noexcept :
+    holder_t(std::move(deque.Allocator())), chunks(nullptr), chunkCount(0), tableSize(0), head(nil), tail(nil), freeHead(nil), size(0) {
+    Steal(deque);
+  }
+
+  /**
+   * Copy operator= (the deque is not changed if copying fails)
+   * @param[in] deque const reference on deque to copy
+   */
+  void operator=(compact_deque_t const& deque) {
+    if (this == &deque)
+      return;
+
+    compact_deque_t copy(Allocator());
+
+    copy.Reserve(deque.size, 0);
+    for (elemType const& elem : deque)
+      copy.PushBack(elem);
+
+    *this = std::move(copy);
+  }
+
+  /**
+   * Move operator=
+   * @param[in] deque rvalue reference on deque to move
+   */
+  void operator=(compact_deque_t&& deque) noexcept {
+    if (this == &deque)
+      return;
+
+    Clear();
+    ReleaseChunks();
+    Allocator() = std::move(deque.Allocator());
+    Steal(deque);
+  }
+
+  /**
+   * Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  bool IsEmpty() const noexcept {
+    return size == 0;
+  }
+
+  /**
+   * Get deque size method
+   * @return number of elements in the deque
+   */
+  size_t Size() const noexcept {
+    return size;
+  }
+
+  /**
+   * Method to see what first element is
+   * @returns const reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType const& PeekHead() const {
+    if (head == nil)
+      throw exception("Deque is empty");
+
+    return Node(head).Value();
+  }
+
+  /**
+   * Method to get first element
+   * @returns reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& GetFront() {
+    if (head == nil)
+      throw exception("Deque is empty");
+
+    return Node(head).Value();
+  }
+
+  /**
+   * Method to see what last element is
+   * @returns const reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType const& PeekTail() const {
+    if (tail == nil)
+      throw exception("Deque is empty");
+
+    return Node(tail).Value();
+  }
+
+  /**
+   * Method to get last element
+   * @returns reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& GetBack() {
+    if (tail == nil)
+      throw exception("Deque is empty");
+
+    return Node(tail).Value();
+  }
+
+  /**
+   * Method to see what first element is without throwing on empty deque
+   * @returns pointer to first element or nullptr if deque is empty
+   */
+  elemType const* TryPeekHead() const noexcept {
+    return head != nil ? &Node(head).Value() : nullptr;
+  }
+
+  /**
+   * Method to see what last element is without throwing on empty deque
+   * @returns pointer to last element or nullptr if deque is empty
+   */
+  elemType const* TryPeekTail() const noexcept {
+    return tail != nil ? &Node(tail).Value() : nullptr;
+  }
+
+  /**
+   * Method to construct element in place at begin of deque
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @returns reference on constructed element
+   * @exception "Deque is full" if no more slot indices are left
+   */
+  template <typename... args>
+  elemType& EmplaceFront(args&&... params) {
+    uint32_t index = TakeSlot();
+    node_t& node = Node(index);
+
+    try {
+      new ((void*)node.storage) elemType(std::forward<args>(params)...);
+    }
+    catch (...) {
+      ReleaseSlot(index);
+      throw;
+    }
+
+    node.prev = nil;
+    node.next = head;
+
+    if (head != nil)
+      Node(head).prev = index;
+    else
+      tail = index;
+
+    head = index;
+    size++;
+
+    return node.Value();
+  }
+
+  /**
+   * Method to construct element in place at end of deque
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @returns reference on constructed element
+   * @exception "Deque is full" if no more slot indices are left
+   */
+  template <typename... args>
+  elemType& EmplaceBack(args&&... params) {
+    uint32_t index = TakeSlot();
+    node_t& node = Node(index);
+
+    try {
+      new ((void*)node.storage) elemType(std::forward<args>(params)...);
+    }
+    catch (...) {
+      ReleaseSlot(index);
+      throw;
+    }
+
+    node.prev = tail;
+    node.next = nil;
+
+    if (tail != nil)
+      Node(tail).next = index;
+    else
+      head = index;
+
+    tail = index;
+    size++;
+
+    return node.Value();
+  }
+
+  /**
+   * Method put element to begin of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushFront(elemType const& elem) {
+    EmplaceFront(elem);
+  }
+
+  /**
+   * Method put element to begin of deque (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushFront(elemType&& elem) {
+    EmplaceFront(std::move(elem));
+  }
+
+  /**
+   * Method put element to end of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushBack(elemType const& elem) {
+    EmplaceBack(elem);
+  }
+
+  /**
+   * Method put element to end of deque (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushBack(elemType&& elem) {
+    EmplaceBack(std::move(elem));
+  }
+
+  /**
+   * Method to remove first element from deque
+   * @exception "Deque is empty" if deque is empty
+   */
+  void PopFront() {
+    if (head == nil)
+      throw exception("Deque is empty");
+
+    uint32_t index = head;
+    node_t& node = Node(index);
+
+    head = node.next;
+    node.Value().~elemType();
+    ReleaseSlot(index);
+
+    if (head == nil)
+      tail = nil;
+    else
+      Node(head).prev = nil;
+
+    size--;
+  }
+
+  /**
+   * Method to remove last element from deque
+   * @exception "Deque is empty" if deque is empty
+   */
+  void PopBack() {
+    if (tail == nil)
+      throw exception("Deque is empty");
+
+    uint32_t index = tail;
+    node_t& node = Node(index);
+
+    tail = node.prev;
+    node.Value().~elemType();
+    ReleaseSlot(index);
+
+    if (tail == nil)
+      head = nil;
+    else
+      Node(tail).next = nil;
+
+    size--;
+  }
+
+  /**
+   * Method to take first element from deque without throwing on empty deque
+   * @returns moved first element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopFront() {
+    if (head == nil)
+      return std::nullopt;
+
+    std::optional<elemType> result(std::move(Node(head).Value()));
+
+    PopFront();
+
+    return result;
+  }
+
+  /**
+   * Method to take last element from deque without throwing on empty deque
+   * @returns moved last element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopBack() {
+    if (tail == nil)
+      return std::nullopt;
+
+    std::optional<elemType> result(std::move(Node(tail).Value()));
+
+    PopBack();
+
+    return result;
+  }
+
+  /**
+   * Get allocator method
+   * @return reference on the allocator used by deque
+   */
+  memoryAllocator& GetAllocator() noexcept {
+    return Allocator();
+  }
+
+  /**
+   * Method to reserve slots for elements
+   *
+   * Both ends share one slot pool, so the counts are summed
+   * @param[in] front number of elements expected to be put to begin of deque
+   * @param[in] back number of elements expected to be put to end of deque
+   * @exception "Deque is full" if no more slot indices are left
+   */
+  void Reserve(size_t front, size_t back) {
+    while (Capacity() < size + front + back)
+      AddChunk();
+  }
+
+  /**
+   * Method to return chunks to the allocator (only an empty deque frees its chunks, since used slots cannot be moved)
+   */
+  void ShrinkToFit() noexcept {
+    if (size == 0)
+      ReleaseChunks();
+  }
+
+  /**
+   * Get deque capacity method
+   * @return number of elements the deque can hold without allocation
+   */
+  size_t Capacity() const noexcept {
+    return chunkCount * chunkSlots;
+  }
+
+  /**
+   * Get node size method
+   * @return number of bytes one element takes in a chunk
+   */
+  static constexpr size_t NodeSize() noexcept {
+    return sizeof(node_t);
+  }
+
+  /**
+   * Write elements to stream separated by 'separator' (numbers are formatted without locale through a buffer)
+   * @param[in] stream output stream
+   * @param[in] separator string written after every element
+   * @return reference to stream
+   */
+  std::ostream& WriteTo(std::ostream& stream, std::string_view separator = " ") const {
+    stream_writer_t writer(stream);
+
+    for (elemType const& elem : *this) {
+      writer.Put(elem);
+      writer.Write(separator);
+    }
+
+    writer.Flush();
+
+    return stream;
+  }
+
+  /**
+   * Clear deque (all slots are returned to the free list at once, chunks are kept)
+   */
+  void Clear() noexcept {
+    if (head == nil)
+      return;
+
+    if constexpr (!std::is_trivially_destructible_v<elemType>)
+      for (uint32_t index = head; index != nil; index = Node(index).next)
+        Node(index).Value().~elemType();
+
+    Node(tail).next = freeHead;
+    freeHead = head;
+    head = nil;
+    tail = nil;
+    size = 0;
+  }
+
+  /**
+   * Deque destructor
+   */
+  ~compact_deque_t() {
+    Clear();
+    ReleaseChunks();
+  }
+};
+
+/**
+ * Operator << for output
+ * @param[in] stream output stream
+ * @param[in] deque deque to output
+ * @return reference to stream
+ */
+template <typename type, typename memoryAllocator, size_t chunkSlots>
+std::ostream& operator<<(std::ostream& stream, compact_deque_t<type, memoryAllocator, chunkSlots> const& deque) {
+  return deque.WriteTo(stream) << '\n';
+}
@@ -0,0 +1,380 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <optional>
+#include <new>
+#include <cstddef>
+#include "allocator.h"
+
+/**
+ * @brief Spin lock
+ *
+ * Test-and-test-and-set lock for very short critical sections, satisfies the Lockable requirements
+ */
+class spin_lock_t {
+private:
+  std::atomic<bool> locked = false;   ///< true if the lock is held
+public:
+  /**
+   * Acquire the lock (spins and then yields while it is held by other thread)
+   */
+  void lock() noexcept {
+    while (locked.exchange(true, std::memory_order_acquire))
+      for (unsigned spins = 0; locked.load(std::memory_order_relaxed); spins++)
+        if (spins > 64)
+          std::this_thread::yield();
+  }
+
+  /**
+   * Try to acquire the lock without waiting
+   * @return true if the lock was acquired, false otherwise
+   */
+  bool try_lock() noexcept {
+    return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+  }
+
+  /**
+   * Release the lock
+   */
+  void unlock() noexcept {
+    locked.store(false, std::memory_order_release);
+  }
+};
+
+/**
+ * @brief Concurrent deque class
+ *
+ * Multi-producer multi-consumer deque with separate locks for the head and the tail.
+ * While the deque holds at least 'fastPathSize' elements, operations at different ends touch disjoint nodes
+ * and run in parallel under their own end lock; near-empty deques take both locks.
+ * Nodes are allocated and freed outside the locks and are never accessed after unlinking,
+ * so there is no ABA problem and no deferred reclamation is needed
+ * @tparam elemType type of stored elements
+ * @tparam memoryAllocator the allocator to be used (calls are serialized unless the allocator is thread-safe)
+ * @see deque_allocator
+ * @see thread_safe_allocator
+ */
+template <typename elemType, deque_allocator memoryAllocator = simple_allocator_t>
+class concurrent_deque_t : private allocator_holder_t<memoryAllocator> {
+private:
+  using holder_t = allocator_holder_t<memoryAllocator>;
+  using holder_t::Allocator;
+
+  /**
+   * @brief deque link struct
+   *
+   * Links of a node (sentinel nodes have links only)
+   */
+  struct link_t {
+    link_t* prev;             ///< pointer to previous node
+    link_t* next;             ///< pointer to next node
+  };
+
+  /**
+   * @brief deque node struct
+   *
+   * The structure of the node storing the value of the specified 'elemType' type
+   */
+  struct node_t : link_t {
+    elemType value;           ///< stored value
+  };
+
+  static constexpr ptrdiff_t fastPathSize = 3;      ///< minimal size at which ends are handled independently
+  static constexpr size_t cacheLineSize = 64;       ///< assumed size of a cache line
+
+  alignas(cacheLineSize) spin_lock_t headLock;      ///< lock of the head end
+  link_t headSentinel;                              ///< sentinel before the first node
+  alignas(cacheLineSize) spin_lock_t tailLock;      ///< lock of the tail end
+  link_t tailSentinel;                              ///< sentinel after the last node
+  alignas(cacheLineSize) std::atomic<ptrdiff_t> size;   ///< number of linked elements (may be temporarily lower)
+  spin_lock_t allocatorLock;                        ///< lock serializing calls of not thread-safe allocator
+
+  /**
+   * Allocate node and construct its value in place
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @return pointer to new node (links are not initialized)
+   */
+  template <typename... args>
+  node_t* CreateNode(args&&... params) {
+    node_t* node;
+
+    if constexpr (thread_safe_allocator<memoryAllocator>)
+      node = (node_t*)AllocAligned<alignof(node_t)>(Allocator(), sizeof(node_t));
+    else {
+      std::lock_guard<spin_lock_t> guard(allocatorLock);
+
+      node = (node_t*)AllocAligned<alignof(node_t)>(Allocator(), sizeof(node_t));
+    }
+
+    try {
+      new ((void*)&node->value) elemType(std::forward<args>(params)...);
+    }
+    catch (...) {
+      Deallocate(node);
+      throw;
+    }
+
+    return node;
+  }
+
+  /**
+   * Return node memory to the allocator
+   * @param[in] node pointer to node
+   */
+  void Deallocate(node_t* node) noexcept {
+    if constexpr (thread_safe_allocator<memoryAllocator>)
+      DeallocAligned<alignof(node_t)>(Allocator(), (void*)node);
+    else {
+      std::lock_guard<spin_lock_t> guard(allocatorLock);
+
+      DeallocAligned<alignof(node_t)>(Allocator(), (void*)node);
+    }
+  }
+
+  /**
+   * Link node after 'pos'
+   * @param[in] pos link to insert after
+   * @param[in] node node to insert
+   */
+  static void LinkAfter(link_t* pos, link_t* node) noexcept {
+    node->prev = pos;
+    node->next = pos->next;
+    pos->next->prev = node;
+    pos->next = node;
+  }
+
+  /**
+   * Unlink node from the list
+   * @param[in] node node to unlink
+   * @return pointer to unlinked node
+   */
+  static node_t* Unlink(link_t* node) noexcept {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+
+    return static_cast<node_t*>(node);
+  }
+
+  /**
+   * Acquire both end locks (always in the same order)
+   */
+  void LockBoth() noexcept {
+    headLock.lock();
+    tailLock.lock();
+  }
+
+  /**
+   * Release both end locks
+   */
+  void UnlockBoth() noexcept {
+    tailLock.unlock();
+    headLock.unlock();
+  }
+
+  /**
+   * Link node at one end of the deque
+   * @param[in] endLock lock of the end
+   * @param[in] atFront true to link node before the first one, false to link it after the last one
+   * @param[in] node node to insert
+   */
+  void LinkAtEnd(spin_lock_t& endLock, bool atFront, node_t* node) noexcept {
+    endLock.lock();
+
+    if (size.load(std::memory_order_acquire) >= fastPathSize) {
+      LinkAfter(atFront ? &headSentinel : tailSentinel.prev, node);
+      size.fetch_add(1, std::memory_order_acq_rel);
+      endLock.unlock();
+      return;
+    }
+
+    endLock.unlock();
+    LockBoth();
+    LinkAfter(atFront ? &headSentinel : tailSentinel.prev, node);
+    size.fetch_add(1, std::memory_order_acq_rel);
+    UnlockBoth();
+  }
+
+  /**
+   * Unlink node from one end of the deque
+   * @param[in] endLock lock of the end
+   * @param[in] atFront true to unlink the first node, false to unlink the last one
+   * @return pointer to unlinked node (nullptr if deque is empty)
+   */
+  node_t* UnlinkAtEnd(spin_lock_t& endLock, bool atFront) noexcept {
+    node_t* node = nullptr;
+
+    endLock.lock();
+
+    if (size.fetch_sub(1, std::memory_order_acq_rel) >= fastPathSize) {
+      node = Unlink(atFront ? headSentinel.next : tailSentinel.prev);
+      endLock.unlock();
+      return node;
+    }
+
+    size.fetch_add(1, std::memory_order_acq_rel);
+    endLock.unlock();
+    LockBoth();
+
+    if (size.load(std::memory_order_relaxed) > 0) {
+      node = Unlink(atFront ? headSentinel.next : tailSentinel.prev);
+      size.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    UnlockBoth();
+
+    return node;
+  }
+
+  /**
+   * Move value out of unlinked node and free the node
+   *
+   * The node is freed even if the move constructor throws (the element is lost then, it is already unlinked)
+   * @param[in] node pointer to node (nullptr if nothing was unlinked)
+   * @return moved value (if node is not nullptr)
+   */
+  std::optional<elemType> Extract(node_t* node) {
+    if (node == nullptr)
+      return std::nullopt;
+
+    std::optional<elemType> result;
+
+    try {
+      result.emplace(std::move(node->value));
+    }
+    catch (...) {
+      node->value.~elemType();
+      Deallocate(node);
+      throw;
+    }
+
+    node->value.~elemType();
+    Deallocate(node);
+
+    return result;
+  }
+public:
+  /**
+   * Default deque constructor
+   */
+  concurrent_deque_t() : size(0) {
+    headSentinel.prev = nullptr;
+    headSentinel.next = &tailSentinel;
+    tailSentinel.prev = &headSentinel;
+    tailSentinel.next = nullptr;
+  }
+
+  /**
+   * Constructor with allocator
+   * @param[in] allocator allocator to be used by deque
+   */
+  explicit concurrent_deque_t(memoryAllocator const& allocator) : holder_t(allocator), size(0) {
+    headSentinel.prev = nullptr;
+    headSentinel.next = &tailSentinel;
+    tailSentinel.prev = &headSentinel;
+    tailSentinel.next = nullptr;
+  }
+
+  concurrent_deque_t(concurrent_deque_t const&) = delete;
+  concurrent_deque_t& operator=(concurrent_deque_t const&) = delete;
+
+  /**
+   * Get deque size method
+   * @return number of elements in the deque (a snapshot that may be outdated at once)
+   */
+  size_t Size() const noexcept {
+    ptrdiff_t count = size.load(std::memory_order_acquire);
+
+    return count > 0 ? (size_t)count : 0;
+  }
+
+  /**
+   * Check is deque empty method
+   * @return true if deque is empty, false otherwise (a snapshot that may be outdated at once)
+   */
+  bool IsEmpty() const noexcept {
+    return Size() == 0;
+  }
+
+  /**
+   * Method to construct element at begin of deque (the element is built before any lock is taken)
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   */
+  template <typename... args>
+  void EmplaceFront(args&&... params) {
+    LinkAtEnd(headLock, true, CreateNode(std::forward<args>(params)...));
+  }
+
+  /**
+   * Method to construct element at end of deque (the element is built before any lock is taken)
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   */
+  template <typename... args>
+  void EmplaceBack(args&&... params) {
+    LinkAtEnd(tailLock, false, CreateNode(std::forward<args>(params)...));
+  }
+
+  /**
+   * Method put element to begin of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushFront(elemType const& elem) {
+    EmplaceFront(elem);
+  }
+
+  /**
+   * Method put element to begin of deque (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushFront(elemType&& elem) {
+    EmplaceFront(std::move(elem));
+  }
+
+  /**
+   * Method put element to end of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushBack(elemType const& elem) {
+    EmplaceBack(elem);
+  }
+
+  /**
+   * Method put element to end of deque (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushBack(elemType&& elem) {
+    EmplaceBack(std::move(elem));
+  }
+
+  /**
+   * Method to take first element from deque
+   * @returns moved first element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopFront() {
+    return Extract(UnlinkAtEnd(headLock, true));
+  }
+
+  /**
+   * Method to take last element from deque
+   * @returns moved last element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopBack() {
+    return Extract(UnlinkAtEnd(tailLock, false));
+  }
+
+  /**
+   * Deque destructor (must not run concurrently with other methods)
+   */
+  ~concurrent_deque_t() {
+    while (headSentinel.next != &tailSentinel) {
+      node_t* node = Unlink(headSentinel.next);
+
+      node->value.~elemType();
+      Deallocate(node);
+    }
+  }
+};
@@ -1,21 +1,42 @@
 ﻿#pragma once
 
 #include <iostream>
+#include <algorithm>
 #include <exception>
+#include <type_traits>
+#include <new>
+#include <iterator>
+#include <ranges>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <functional>
 #include "allocator.h"
+#include "iterator_policy.h"
+#include "parallel.h"
+#include "stream_writer.h"
+#include "snapshot.h"
+#include "deque_stats.h"
 
 using std::exception;
 
 /**
  * @brief Deque class
+ *
+ * If DEQUE_STATS is set, operations, node allocations and "Deque is empty" errors are counted in deque_stats_t
  * @tparam elemType type of stored elements
  * @tparam memoryAllocator the allocator to be used (allocator based on malloc/free is used by default)
- * @warning for guaranteed compatibility, the allocator must be inherited from allocator_interface_t
- * @see allocator_interface_t
+ * @see deque_allocator
+ * @see polymorphic_allocator_t
  */
-template <typename elemType, typename memoryAllocator = simple_allocator_t>
-class deque_t {
+template <typename elemType, deque_allocator memoryAllocator = simple_allocator_t>
+class deque_t : private allocator_holder_t<memoryAllocator> {
 private:
+  using holder_t = allocator_holder_t<memoryAllocator>;
+  using holder_t::Allocator;
+
   /**
    * @brief deque node struct
    * 
@@ -29,20 +50,448 @@ private:
 
   node_t* head;               ///< pointer to the beginning of the deque (nullptr if the deque is empty)
   node_t* tail;               ///< pointer to the end of the deque (nullptr if the deque is empty)
-  unsigned int size;          ///< number of elements in the deque
+  size_t size;                ///< number of elements in the deque
+  node_t* spare;              ///< list of allocated unused nodes linked by 'next' (nullptr if there are none)
+  size_t spareCount;          ///< number of nodes in the spare list
+  size_t spareLimit;          ///< maximal number of removed nodes kept in the spare list (set by Reserve)
+  std::unique_ptr<std::deque<node_t*>> skipIndex;   ///< every 'skipStep'-th node in order for InsertSorted and parallel algorithms (allocated by the first use)
+
+  static constexpr size_t skipStep = 32;   ///< number of nodes between entries of the skip index
 
-  memoryAllocator allocator;  ///< the allocator to be used
-public:
   /**
-   * Friend operator<< for deque
-   * @tparam type type of deque elements
-   * @param[in] stream output stream
-   * @param[in] deque deque to output
-   * @return reference to stream
+   * Compare allocators of two deques (used if the allocator provides operator==)
+   * @param[in] a first allocator
+   * @param[in] b second allocator
+   * @return true if nodes allocated by one allocator can be deallocated by other one
+   */
+  template <typename alloc>
+  static auto IsSameAllocator(alloc const& a, alloc const& b, int) -> decltype(bool(a == b)) {
+    return a == b;
+  }
+
+  /**
+   * Compare allocators of two deques (used if the allocator has no operator==, such allocators are interchangeable)
+   * @return true
+   */
+  template <typename alloc>
+  static bool IsSameAllocator(alloc const&, alloc const&, long) {
+    return true;
+  }
+  /**
+   * Allocate node and construct its value in place
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @return pointer to new node (links are not initialized)
+   */
+  template <typename... args>
+  node_t* CreateNode(args&&... params) {
+    node_t* node;
+
+    if (spare) {
+      node = spare;
+      spare = spare->next;
+      spareCount--;
+    }
+    else {
+      node = (node_t*)AllocAligned<alignof(node_t)>(Allocator(), sizeof(node_t));
+      deque_stats_t::CountAlloc(NodeSize());
+    }
+
+    try {
+      new ((void*)&node->value) elemType(std::forward<args>(params)...);
+    }
+    catch (...) {
+      ReleaseNode(node);
+      throw;
+    }
+
+    return node;
+  }
+
+  /**
+   * Put node memory to the spare list if it is not full, deallocate it otherwise
+   * @param[in] node pointer to node without value
+   */
+  void ReleaseNode(node_t* node) noexcept {
+    if (spareCount < spareLimit) {
+      node->next = spare;
+      spare = node;
+      spareCount++;
+    }
+    else {
+      DeallocAligned<alignof(node_t)>(Allocator(), (void*)node);
+      deque_stats_t::CountDealloc(NodeSize());
+    }
+  }
+
+  /**
+   * Destroy node value and release node
+   * @param[in] node pointer to node
+   */
+  void DestroyNode(node_t* node) noexcept {
+    node->value.~elemType();
+    ReleaseNode(node);
+  }
+
+  /**
+   * Deallocate all nodes of the spare list
+   */
+  void ReleaseSpares() noexcept {
+    while (spare) {
+      node_t* node = spare;
+
+      spare = spare->next;
+      DeallocAligned<alignof(node_t)>(Allocator(), (void*)node);
+      deque_stats_t::CountDealloc(NodeSize());
+    }
+
+    spareCount = 0;
+  }
+
+  /**
+   * Take nodes of other deque leaving it empty (allocator is not touched)
+   * @param[in] deque reference on deque to take nodes from
+   */
+  void Steal(deque_t& deque) noexcept {
+    skipIndex = std::move(deque.skipIndex);
+    head = deque.head;
+    tail = deque.tail;
+    size = deque.size;
+    spare = deque.spare;
+    spareCount = deque.spareCount;
+    spareLimit = deque.spareLimit;
+
+    deque.head = nullptr;
+    deque.tail = nullptr;
+    deque.size = 0;
+    deque.spare = nullptr;
+    deque.spareCount = 0;
+    deque.spareLimit = 0;
+  }
+
+  /**
+   * Count elements relinked from other deque as removed from it and put to the current one
+   * @param[in] fromFront true if elements are taken from begin of other deque, false if from its end
+   * @param[in] toFront true if elements are put to begin of the current deque, false if to its end or middle
+   * @param[in] count number of elements
+   * @param[in] newSize size of the current deque after the elements are put
+   */
+  static void CountMoved(bool fromFront, bool toFront, size_t count, size_t newSize) noexcept {
+    deque_stats_t::CountPop(fromFront, count);
+    deque_stats_t::CountPush(toFront, count);
+    deque_stats_t::CountSize(newSize);
+  }
+
+  /**
+   * Pre-reserve nodes in the allocator if it supports reservation (e.g. pool_allocator_t)
+   * @param[in] count number of nodes to reserve
+   */
+  void ReserveNodes(size_t count) {
+    if constexpr (requires(memoryAllocator& a) { a.Reserve(count, NodeSize()); })
+      Allocator().Reserve(count, NodeSize());
+  }
+
+  /**
+   * Build a chain of nodes from range (all nodes are freed if an element constructor throws)
+   * @tparam inputIter type of range iterator
+   * @param[in] from iterator to the first element of range
+   * @param[in] to iterator to the element after the last one
+   * @param[out] chainHead pointer to the first node of chain (nullptr if range is empty)
+   * @param[out] chainTail pointer to the last node of chain (nullptr if range is empty)
+   * @return number of nodes in chain
+   */
+  template <typename inputIter>
+  size_t CreateChain(inputIter from, inputIter to, node_t*& chainHead, node_t*& chainTail) {
+    size_t count = 0;
+
+    chainHead = nullptr;
+    chainTail = nullptr;
+
+    try {
+      for (; from != to; ++from, count++) {
+        node_t* node = CreateNode(*from);
+
+        node->next = nullptr;
+        node->prev = chainTail;
+
+        if (chainTail)
+          chainTail->next = node;
+        else
+          chainHead = node;
+
+        chainTail = node;
+      }
+    }
+    catch (...) {
+      while (chainHead) {
+        node_t* tmp = chainHead;
+
+        chainHead = chainHead->next;
+        DestroyNode(tmp);
+      }
+
+      throw;
+    }
+
+    return count;
+  }
+
+  /**
+   * Link a chain of nodes to the end of deque
+   * @param[in] chainHead pointer to the first node of chain
+   * @param[in] chainTail pointer to the last node of chain
+   * @param[in] count number of nodes in chain
+   */
+  void SpliceBack(node_t* chainHead, node_t* chainTail, size_t count) noexcept {
+    chainHead->prev = tail;
+
+    if (tail)
+      tail->next = chainHead;
+    else
+      head = chainHead;
+
+    tail = chainTail;
+    size += count;
+  }
+
+  /**
+   * Link a chain of nodes to the begin of deque
+   * @param[in] chainHead pointer to the first node of chain
+   * @param[in] chainTail pointer to the last node of chain
+   * @param[in] count number of nodes in chain
+   */
+  void SpliceFront(node_t* chainHead, node_t* chainTail, size_t count) noexcept {
+    chainTail->next = head;
+
+    if (head)
+      head->prev = chainTail;
+    else
+      tail = chainTail;
+
+    head = chainHead;
+    size += count;
+  }
+
+  /**
+   * Make node the first one after removing nodes before it
+   * @param[in] node pointer to new first node (nullptr if deque becomes empty)
+   * @param[in] removed number of removed nodes
+   */
+  void DetachFront(node_t* node, size_t removed) noexcept {
+    head = node;
+
+    if (head)
+      head->prev = nullptr;
+    else
+      tail = nullptr;
+
+    size -= removed;
+  }
+
+  /**
+   * Make node the last one after removing nodes after it
+   * @param[in] node pointer to new last node (nullptr if deque becomes empty)
+   * @param[in] removed number of removed nodes
+   */
+  void DetachBack(node_t* node, size_t removed) noexcept {
+    tail = node;
+
+    if (tail)
+      tail->next = nullptr;
+    else
+      head = nullptr;
+
+    size -= removed;
+  }
+
+  /**
+   * Link a chain of nodes before node of deque
+   * @param[in] pos pointer to node to link chain before (nullptr to link at the end)
+   * @param[in] chainHead pointer to the first node of chain
+   * @param[in] chainTail pointer to the last node of chain
+   * @param[in] count number of nodes in chain
+   */
+  void LinkBefore(node_t* pos, node_t* chainHead, node_t* chainTail, size_t count) noexcept {
+    if (pos == nullptr) {
+      chainTail->next = nullptr;
+      SpliceBack(chainHead, chainTail, count);
+    }
+    else if (pos == head) {
+      chainHead->prev = nullptr;
+      SpliceFront(chainHead, chainTail, count);
+    }
+    else {
+      chainHead->prev = pos->prev;
+      chainTail->next = pos;
+      pos->prev->next = chainHead;
+      pos->prev = chainTail;
+      size += count;
+    }
+  }
+
+  /**
+   * Unlink a chain of nodes from deque (nodes are not freed)
+   * @param[in] chainHead pointer to the first node of chain
+   * @param[in] chainTail pointer to the last node of chain
+   * @param[in] count number of nodes in chain
+   */
+  void Unlink(node_t* chainHead, node_t* chainTail, size_t count) noexcept {
+    ClearSkipIndex();
+
+    if (chainHead->prev)
+      chainHead->prev->next = chainTail->next;
+    else
+      head = chainTail->next;
+
+    if (chainTail->next)
+      chainTail->next->prev = chainHead->prev;
+    else
+      tail = chainHead->prev;
+
+    chainHead->prev = nullptr;
+    chainTail->next = nullptr;
+    size -= count;
+  }
+
+  /**
+   * Drop all entries of the skip index (its memory is kept)
+   */
+  void ClearSkipIndex() noexcept {
+    if (skipIndex)
+      skipIndex->clear();
+  }
+
+  /**
+   * Drop the first entry of the skip index if it is the first node, which is leaving the deque
+   * @param[in] node pointer to the first node
+   */
+  void ForgetFront(node_t const* node) noexcept {
+    if (skipIndex && !skipIndex->empty() && skipIndex->front() == node)
+      skipIndex->pop_front();
+  }
+
+  /**
+   * Drop the last entry of the skip index if it is the last node, which is leaving the deque
+   * @param[in] node pointer to the last node
+   */
+  void ForgetBack(node_t const* node) noexcept {
+    if (skipIndex && !skipIndex->empty() && skipIndex->back() == node)
+      skipIndex->pop_back();
+  }
+
+  /**
+   * Rebuild the skip index from every 'skipStep'-th node
+   */
+  void BuildSkipIndex() {
+    if (skipIndex)
+      skipIndex->clear();
+    else
+      skipIndex = std::make_unique<std::deque<node_t*>>();
+
+    size_t index = 0;
+
+    for (node_t* node = head; node; node = node->next, index++)
+      if (index % skipStep == 0)
+        skipIndex->push_back(node);
+  }
+
+  /**
+   * Find position of element in sorted deque after all elements equal to it
+   *
+   * Up to 'skipStep' nodes are checked from the tail, so almost sorted input costs O(1) per element;
+   * farther positions are found by binary search in the skip index (built here if it is empty) and a short walk
+   * @tparam compare type of comparison called as comp(elemType const&, elemType const&)
+   * @param[in] elem element to find position for
+   * @param[in] comp comparison the deque is sorted by
+   * @return pointer to the first node greater than 'elem' (nullptr if there is none)
+   */
+  template <typename compare>
+  node_t* FindSortedPos(elemType const& elem, compare const& comp) {
+    node_t* node = tail;
+
+    for (size_t steps = 0; steps < skipStep; steps++, node = node->prev)
+      if (node == nullptr || !comp(elem, node->value))
+        return node ? node->next : head;
+
+    if (!skipIndex || skipIndex->empty())
+      BuildSkipIndex();
+
+    auto anchor = std::upper_bound(skipIndex->begin(), skipIndex->end(), elem, [&comp](elemType const& value, node_t const* entry) {
+      return comp(value, entry->value);
+    });
+    size_t steps = 0;
+
+    for (node = anchor == skipIndex->begin() ? head : *(anchor - 1); node && !comp(elem, node->value); node = node->next)
+      steps++;
+
+    if (steps > 2 * skipStep)
+      skipIndex->clear();   // the span grew by insertions, rebuild the index by the next search
+
+    return node;
+  }
+
+  /**
+   * Count nodes from node to the end of deque walking from it to both ends at once
+   * @param[in] node pointer to node of deque
+   * @return number of nodes from 'node' to the end, found in min(index, size - index) steps
+   */
+  size_t CountToEnd(node_t const* node) const noexcept {
+    node_t const* forward = node;
+    node_t const* backward = node;
+    size_t steps = 0;
+
+    for (;; steps++) {
+      if (forward == nullptr)
+        return steps;
+      if (backward == nullptr)
+        return size - steps + 1;
+
+      forward = forward->next;
+      backward = backward->prev;
+    }
+  }
+
+  /**
+   * Check that the skip index can split deque into segments
+   * @param[in] segments number of segments
+   * @return true if one segment is enough or the index is not empty and its spans did not grow twice by insertions
+   */
+  bool SkipIndexFits(size_t segments) const noexcept {
+    return segments <= 1 || (skipIndex ? skipIndex->size() : 0) * skipStep * 2 >= (size_t)size;
+  }
+
+  /**
+   * Find bounds of segments for parallel algorithms (the deque is only read)
+   *
+   * Bounds are taken from the skip index in O(segments) if it fits (see SkipIndexFits),
+   * otherwise they are found by one walk over the list
+   * @param[in] segments number of segments (not greater than size / skipStep)
+   * @return 'segments' + 1 pointers, segment k covers nodes from bounds[k] up to bounds[k + 1] (nullptr is the end)
    */
-  template <typename type>
-  friend std::ostream& operator<<(std::ostream& stream, deque_t<type> const& deque);
+  std::vector<node_t*> SegmentBounds(size_t segments) const {
+    std::vector<node_t*> bounds(segments + 1, nullptr);
+
+    if (segments == 0)
+      return bounds;
+
+    bounds[0] = head;
+
+    if (SkipIndexFits(segments))
+      for (size_t k = 1; k < segments; k++)
+        bounds[k] = (*skipIndex)[skipIndex->size() * k / segments];
+    else {
+      node_t* node = head;
+
+      for (size_t k = 1, i = 0; k < segments; k++) {
+        for (; i < (size_t)size * k / segments; i++)
+          node = node->next;
+        bounds[k] = node;
+      }
+    }
 
+    return bounds;
+  }
+public:
   /**
    * @brief Deque iterator
    * 
@@ -50,6 +499,8 @@ public:
    */
   class iterator {
   private:
+    friend class deque_t;
+
     node_t* curNode;   ///< Pointer to the deque node to which the iterator corresponds
   public:
     /**
@@ -92,11 +543,12 @@ public:
     /**
      * Prefix ++ operator
      * @return reference to next iterator
-     * @exception "Try to use end iterator" if curNode is equal to nullptr
+     * @exception "Try to use end iterator" if curNode is equal to nullptr (checked iterators only)
      */
-    iterator& operator++() {
-      if (curNode == nullptr)
-        throw exception("Try to use end iterator");
+    iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (curNode == nullptr)
+          throw exception("Try to use end iterator");
 
       curNode = curNode->next;
 
@@ -106,11 +558,12 @@ public:
     /**
      * Postfix ++ operator
      * @return reference to current iterator
-     * @exception "Try to use end iterator" if curNode is equal to nullptr
+     * @exception "Try to use end iterator" if curNode is equal to nullptr (checked iterators only)
      */
-    iterator operator++(int) {
-      if (curNode == nullptr)
-        throw exception("Try to use end iterator");
+    iterator operator++(int) noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (curNode == nullptr)
+          throw exception("Try to use end iterator");
 
       iterator tmp = *this;
 
@@ -140,11 +593,12 @@ public:
     /**
      * Operator *
      * @return reference on value to which the iterator corresponds
-     * @exception "Try to use end iterator" if curNode is equal to nullptr
+     * @exception "Try to use end iterator" if curNode is equal to nullptr (checked iterators only)
      */
-    elemType& operator*() {
-      if (curNode == nullptr)
-        throw exception("Try to use end iterator");
+    elemType& operator*() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (curNode == nullptr)
+          throw exception("Try to use end iterator");
 
       return curNode->value;
     }
@@ -215,11 +669,12 @@ public:
     /**
      * Prefix ++ operator
      * @return reference to next iterator
-     * @exception "Try to use end iterator" if curNode is equal to nullptr
+     * @exception "Try to use end iterator" if curNode is equal to nullptr (checked iterators only)
      */
-    const_iterator& operator++() {
-      if (curNode == nullptr)
-        throw exception("Try to use end iterator");
+    const_iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (curNode == nullptr)
+          throw exception("Try to use end iterator");
 
       curNode = curNode->next;
 
@@ -229,11 +684,12 @@ public:
     /**
      * Postfix ++ operator
      * @return reference to current iterator
-     * @exception "Try to use end iterator" if curNode is equal to nullptr
+     * @exception "Try to use end iterator" if curNode is equal to nullptr (checked iterators only)
      */
-    const_iterator operator++(int) {
-      if (curNode == nullptr)
-        throw exception("Try to use end iterator");
+    const_iterator operator++(int) noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (curNode == nullptr)
+          throw exception("Try to use end iterator");
 
       const_iterator tmp = *this;
 
@@ -263,11 +719,12 @@ public:
     /**
      * Operator *
      * @return reference on value to which the iterator corresponds
-     * @exception "Try to use end iterator" if curNode is equal to nullptr
+     * @exception "Try to use end iterator" if curNode is equal to nullptr (checked iterators only)
      */
-    const elemType& operator*() {
-      if (curNode == nullptr)
-        throw exception("Try to use end iterator");
+    const elemType& operator*() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (curNode == nullptr)
+          throw exception("Try to use end iterator");
 
       return curNode->value;
     }
@@ -338,11 +795,12 @@ public:
     /**
      * Prefix ++ operator
      * @return reference to next reverse iterator
-     * @exception "Try to use end iterator" if curNode is equal to nullptr
+     * @exception "Try to use end iterator" if curNode is equal to nullptr (checked iterators only)
      */
-    reverse_iterator& operator++() {
-      if (curNode == nullptr)
-        throw exception("Try to use end iterator");
+    reverse_iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (curNode == nullptr)
+          throw exception("Try to use end iterator");
 
       curNode = curNode->prev;
 
@@ -352,11 +810,12 @@ public:
     /**
      * Postfix ++ operator
      * @return reference to current reverse iterator
-     * @exception "Try to use end iterator" if curNode is equal to nullptr
+     * @exception "Try to use end iterator" if curNode is equal to nullptr (checked iterators only)
      */
-    reverse_iterator operator++(int) {
-      if (curNode == nullptr)
-        throw exception("Try to use end iterator");
+    reverse_iterator operator++(int) noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (curNode == nullptr)
+          throw exception("Try to use end iterator");
 
       reverse_iterator tmp = *this;
 
@@ -386,11 +845,12 @@ public:
     /**
      * Operator *
      * @return reference on value to which the iterator corresponds
-     * @exception "Try to use end iterator" if curNode is equal to nullptr
+     * @exception "Try to use end iterator" if curNode is equal to nullptr (checked iterators only)
      */
-    elemType& operator*() {
-      if (curNode == nullptr)
-        throw exception("Try to use end iterator");
+    elemType& operator*() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (curNode == nullptr)
+          throw exception("Try to use end iterator");
 
       return curNode->value;
     }
@@ -415,49 +875,88 @@ public:
   /**
    * Default deque constructor
    */
-  deque_t() : head(nullptr), tail(nullptr), size(0) {};
+  deque_t() : head(nullptr), tail(nullptr), size(0), spare(nullptr), spareCount(0), spareLimit(0) {};
+
+  /**
+   * Constructor with allocator
+   * @param[in] allocator allocator to be used by deque
+   */
+  explicit deque_t(memoryAllocator const& allocator) : holder_t(allocator), head(nullptr), tail(nullptr), size(0), spare(nullptr), spareCount(0), spareLimit(0) {};
 
   /**
    * Deque constructor with initializer list
    * @param[in] list list of 'elemType' values
    */
-  deque_t(std::initializer_list<elemType> list) : head(nullptr), tail(nullptr), size(0) {
-    for (auto& l : list)
-      PushBack(l);
+  deque_t(std::initializer_list<elemType> list) : head(nullptr), tail(nullptr), size(0), spare(nullptr), spareCount(0), spareLimit(0) {
+    PushBackRange(list.begin(), list.end());
   };
 
   /**
-   * Copy constructor
+   * Copy constructor (nodes are reserved at once, nothing is leaked if an element constructor throws)
    * @param[in] deque const reference on deque to copy
    */
-  deque_t(deque_t const& deque) : head(nullptr), tail(nullptr), size(0) {
-    for (auto& d : deque)
-      PushBack(d);
+  deque_t(deque_t const& deque) : holder_t(deque.Allocator()), head(nullptr), tail(nullptr), size(0), spare(nullptr), spareCount(0), spareLimit(0) {
+    AddOtherDeque(deque);
   };
 
   /**
    * Move constructor
    * @param[in] deque rvalue reference on deque to move
    */
-  deque_t(deque_t&& deque) {
-    head = deque.head;
-    tail = deque.tail;
-    size = deque.size;
-
-    deque.head = nullptr;
-    deque.tail = nullptr;
-    deque.size = 0;
+  deque_t(deque_t&& deque) : holder_t(std::move(deque.Allocator())) {
+    Steal(deque);
   };
 
   /**
    * Copy operator=
+   *
+   * If elements are nothrow copy assignable, existing nodes are reused by assigning into them and only the size
+   * difference is allocated or freed; otherwise the copy is built before old elements are removed.
+   * If an element constructor throws, the deque is not changed
    * @param[in] deque const reference on deque to copy
    */
   void operator=(deque_t const& deque) {
-    Clear();
+    if (this == &deque)
+      return;
+
+    node_t* chainHead;
+    node_t* chainTail;
 
-    for (auto& d : deque)
-      PushBack(d);
+    if constexpr (std::is_nothrow_copy_assignable_v<elemType>) {
+      node_t const* src = deque.head;
+      size_t count = 0;
+
+      if (deque.size > size) {
+        for (size_t i = 0; i < size; i++)
+          src = src->next;
+
+        ReserveNodes(deque.size - size);
+        count = CreateChain(const_iterator(src), const_iterator(nullptr), chainHead, chainTail);
+        src = deque.head;
+      }
+
+      for (node_t* dst = head; src && dst; dst = dst->next, src = src->next)
+        dst->value = src->value;
+
+      if (count)
+        SpliceBack(chainHead, chainTail, count);
+
+      while (size > deque.size)
+        PopBack();
+    }
+    else {
+      size_t old = size;
+
+      ReserveNodes(deque.size);
+
+      size_t count = CreateChain(deque.begin(), deque.end(), chainHead, chainTail);
+
+      if (count)
+        SpliceBack(chainHead, chainTail, count);
+
+      for (; old; old--)
+        PopFront();
+    }
   }
 
   /**
@@ -465,14 +964,13 @@ public:
    * @param[in] deque rvalue reference on deque to move
    */
   void operator=(deque_t&& deque) {
-    Clear();
-    head = deque.head;
-    tail = deque.tail;
-    size = deque.size;
+    if (this == &deque)
+      return;
 
-    deque.head = nullptr;
-    deque.tail = nullptr;
-    deque.size = 0;
+    Clear();
+    ReleaseSpares();
+    Allocator() = std::move(deque.Allocator());
+    Steal(deque);
   }
 
   /**
@@ -487,7 +985,7 @@ public:
    * Get deque size method
    * @return number of elements in the deque
    */
-  unsigned int Size() const {
+  size_t Size() const {
     return size;
   }
 
@@ -497,8 +995,10 @@ public:
    * @exception "Deque is empty" if deque is empty
    */
   elemType const& PeekHead() const {
-    if (!head)
+    if (!head) {
+      deque_stats_t::CountEmptyError();
       throw exception("Deque is empty");
+    }
 
     return head->value;
   }
@@ -509,8 +1009,10 @@ public:
    * @exception "Deque is empty" if deque is empty
    */
   elemType& GetFront() {
-    if (!head)
+    if (!head) {
+      deque_stats_t::CountEmptyError();
       throw exception("Deque is empty");
+    }
 
     return head->value;
   }
@@ -521,8 +1023,10 @@ public:
    * @exception "Deque is empty" if deque is empty
    */
   elemType const& PeekTail() const {
-    if (!tail)
+    if (!tail) {
+      deque_stats_t::CountEmptyError();
       throw exception("Deque is empty");
+    }
 
     return tail->value;
   }
@@ -533,42 +1037,40 @@ public:
    * @exception "Deque is empty" if deque is empty
    */
   elemType& GetBack() {
-    if (!tail)
+    if (!tail) {
+      deque_stats_t::CountEmptyError();
       throw exception("Deque is empty");
+    }
 
     return tail->value;
   }
 
   /**
-   * Method put element to begin of deque (copy semantics)
-   * @param[in] elem const reference on element
+   * Method to see what first element is without throwing on empty deque
+   * @returns pointer to first element or nullptr if deque is empty
    */
-  void PushFront(elemType const& elem) {
-    node_t* tmp = (node_t*)allocator.alloc(sizeof(node_t));
-
-    tmp->value = elem;
-    tmp->next = head;
-    tmp->prev = nullptr;
-
-    if (head)
-      head->prev = tmp;
-
-    head = tmp;
+  elemType const* TryPeekHead() const noexcept {
+    return head ? &head->value : nullptr;
+  }
 
-    if (tail == nullptr)
-      tail = head;
-    
-    size++;
+  /**
+   * Method to see what last element is without throwing on empty deque
+   * @returns pointer to last element or nullptr if deque is empty
+   */
+  elemType const* TryPeekTail() const noexcept {
+    return head ? &tail->value : nullptr;
   }
 
   /**
-   * Method put element to begin of deque (move semantics)
-   * @param[in] elem rvalue reference on element
+   * Method to construct element in place at begin of deque
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @returns reference on constructed element
    */
-  void PushFront(elemType&& elem) {
-    node_t* tmp = (node_t*)allocator.alloc(sizeof(node_t));
+  template <typename... args>
+  elemType& EmplaceFront(args&&... params) {
+    node_t* tmp = CreateNode(std::forward<args>(params)...);
 
-    tmp->value = std::move(elem);
     tmp->next = head;
     tmp->prev = nullptr;
 
@@ -581,16 +1083,22 @@ public:
       tail = head;
 
     size++;
+    deque_stats_t::CountPush(true);
+    deque_stats_t::CountSize(size);
+
+    return tmp->value;
   }
 
   /**
-   * Method put element to end of deque (copy semantics)
-   * @param[in] elem const reference on element
+   * Method to construct element in place at end of deque
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @returns reference on constructed element
    */
-  void PushBack(elemType const& elem) {
-    node_t* tmp = (node_t*)allocator.alloc(sizeof(node_t));
+  template <typename... args>
+  elemType& EmplaceBack(args&&... params) {
+    node_t* tmp = CreateNode(std::forward<args>(params)...);
 
-    tmp->value = elem;
     tmp->next = nullptr;
     tmp->prev = tail;
 
@@ -603,28 +1111,122 @@ public:
       head = tail;
 
     size++;
+    deque_stats_t::CountPush(false);
+    deque_stats_t::CountSize(size);
+
+    return tmp->value;
   }
 
   /**
-   * Method put element to end of deque (move semantics)
+   * Method put element to begin of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushFront(elemType const& elem) {
+    EmplaceFront(elem);
+  }
+
+  /**
+   * Method put element to begin of deque (move semantics)
    * @param[in] elem rvalue reference on element
    */
-  void PushBack(elemType&& elem) {
-    node_t* tmp = (node_t*)allocator.alloc(sizeof(node_t));
+  void PushFront(elemType&& elem) {
+    EmplaceFront(std::move(elem));
+  }
 
-    tmp->value = std::move(elem);
-    tmp->next = nullptr;
-    tmp->prev = tail;
+  /**
+   * Method put element to end of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushBack(elemType const& elem) {
+    EmplaceBack(elem);
+  }
 
-    if (tail)
-      tail->next = tmp;
+  /**
+   * Method put element to end of deque (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushBack(elemType&& elem) {
+    EmplaceBack(std::move(elem));
+  }
 
-    tail = tmp;
+  /**
+   * Method put range of elements to end of deque
+   *
+   * Nodes for the whole range are built first (reserved at once if the allocator supports it) and then linked in one splice;
+   * if an element constructor throws, the deque is not changed
+   * @tparam inputIter type of range iterator
+   * @param[in] from iterator to the first element of range
+   * @param[in] to iterator to the element after the last one
+   * @returns refernece on current deque
+   */
+  template <typename inputIter>
+  deque_t& PushBackRange(inputIter from, inputIter to) {
+    node_t* chainHead;
+    node_t* chainTail;
 
-    if (head == nullptr)
-      head = tail;
+    if constexpr (std::forward_iterator<inputIter>)
+      ReserveNodes((size_t)std::distance(from, to));
 
-    size++;
+    size_t count = CreateChain(from, to, chainHead, chainTail);
+
+    if (count)
+      SpliceBack(chainHead, chainTail, count);
+
+    deque_stats_t::CountPush(false, count);
+    deque_stats_t::CountSize(size);
+
+    return *this;
+  }
+
+  /**
+   * Method put range of elements to end of deque
+   * @tparam range type of range (container, span, etc.)
+   * @param[in] elems range of elements
+   * @returns refernece on current deque
+   */
+  template <std::ranges::input_range range> requires std::ranges::common_range<range>
+  deque_t& PushBackRange(range&& elems) {
+    return PushBackRange(std::ranges::begin(elems), std::ranges::end(elems));
+  }
+
+  /**
+   * Method put range of elements to begin of deque (the first element of range becomes the first element of deque)
+   *
+   * Nodes for the whole range are built first (reserved at once if the allocator supports it) and then linked in one splice;
+   * if an element constructor throws, the deque is not changed
+   * @tparam inputIter type of range iterator
+   * @param[in] from iterator to the first element of range
+   * @param[in] to iterator to the element after the last one
+   * @returns refernece on current deque
+   */
+  template <typename inputIter>
+  deque_t& PushFrontRange(inputIter from, inputIter to) {
+    node_t* chainHead;
+    node_t* chainTail;
+
+    if constexpr (std::forward_iterator<inputIter>)
+      ReserveNodes((size_t)std::distance(from, to));
+
+    size_t count = CreateChain(from, to, chainHead, chainTail);
+
+    if (count)
+      SpliceFront(chainHead, chainTail, count);
+
+    deque_stats_t::CountPush(true, count);
+    deque_stats_t::CountSize(size);
+
+    return *this;
+  }
+
+  /**
+   * Method put range of elements to begin of deque (the first element of range becomes the first element of deque)
+   * @tparam range type of range (container, span, etc.)
+   * @param[in] elems range of elements
+   * @returns refernece on current deque
+   */
+  template <std::ranges::input_range range> requires std::ranges::common_range<range>
+  deque_t& PushFrontRange(range&& elems) {
+    return PushFrontRange(std::ranges::begin(elems), std::ranges::end(elems));
   }
 
   /**
@@ -632,13 +1234,16 @@ public:
    * @exception "Deque is empty" if deque is empty
    */
   void PopFront() {
-    if (head == nullptr)
+    if (head == nullptr) {
+      deque_stats_t::CountEmptyError();
       throw exception("Deque is empty");
+    }
 
     node_t* tmp = head;
 
     head = head->next;
-    allocator.dealloc((void*)tmp);
+    ForgetFront(tmp);
+    DestroyNode(tmp);
 
     if (head == nullptr)
       tail = nullptr;
@@ -646,6 +1251,7 @@ public:
       head->prev = nullptr;
 
     size--;
+    deque_stats_t::CountPop(true);
   }
 
   /**
@@ -653,13 +1259,16 @@ public:
    * @exception "Deque is empty" if deque is empty
    */
   void PopBack() {
-    if (tail == nullptr)
+    if (tail == nullptr) {
+      deque_stats_t::CountEmptyError();
       throw exception("Deque is empty");
+    }
 
     node_t* tmp = tail;
 
     tail = tail->prev;
-    allocator.dealloc((void*)tmp);
+    ForgetBack(tmp);
+    DestroyNode(tmp);
 
     if (tail == nullptr)
       head = nullptr;
@@ -667,6 +1276,133 @@ public:
       tail->next = nullptr;
 
     size--;
+    deque_stats_t::CountPop(false);
+  }
+
+  /**
+   * Method to take first element from deque without throwing on empty deque
+   * @returns moved first element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopFront() {
+    if (head == nullptr)
+      return std::nullopt;
+
+    std::optional<elemType> result(std::move(head->value));
+
+    PopFront();
+
+    return result;
+  }
+
+  /**
+   * Method to take last element from deque without throwing on empty deque
+   * @returns moved last element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopBack() {
+    if (tail == nullptr)
+      return std::nullopt;
+
+    std::optional<elemType> result(std::move(tail->value));
+
+    PopBack();
+
+    return result;
+  }
+
+  /**
+   * Method to move up to 'count' first elements out of deque
+   *
+   * Elements are moved to the output in direct order and removed without emptiness checks per element
+   * @tparam outputIter type of output iterator
+   * @param[in] count maximum number of elements to remove
+   * @param[in] out output iterator to move elements to
+   * @returns output iterator after the last written element
+   */
+  template <typename outputIter>
+  outputIter PopFrontN(size_t count, outputIter out) {
+    node_t* node = head;
+    size_t popped = 0;
+
+    try {
+      for (; popped < count && node; popped++) {
+        node_t* next = node->next;
+
+        *out = std::move(node->value);
+        ++out;
+        ForgetFront(node);
+        DestroyNode(node);
+        node = next;
+      }
+    }
+    catch (...) {
+      DetachFront(node, popped);
+      deque_stats_t::CountPop(true, popped);
+      throw;
+    }
+
+    DetachFront(node, popped);
+    deque_stats_t::CountPop(true, popped);
+
+    return out;
+  }
+
+  /**
+   * Method to move up to 'count' last elements out of deque
+   *
+   * Elements are moved to the output in reverse order and removed without emptiness checks per element
+   * @tparam outputIter type of output iterator
+   * @param[in] count maximum number of elements to remove
+   * @param[in] out output iterator to move elements to
+   * @returns output iterator after the last written element
+   */
+  template <typename outputIter>
+  outputIter PopBackN(size_t count, outputIter out) {
+    node_t* node = tail;
+    size_t popped = 0;
+
+    try {
+      for (; popped < count && node; popped++) {
+        node_t* next = node->prev;
+
+        *out = std::move(node->value);
+        ++out;
+        ForgetBack(node);
+        DestroyNode(node);
+        node = next;
+      }
+    }
+    catch (...) {
+      DetachBack(node, popped);
+      deque_stats_t::CountPop(false, popped);
+      throw;
+    }
+
+    DetachBack(node, popped);
+    deque_stats_t::CountPop(false, popped);
+
+    return out;
+  }
+
+  /**
+   * Method to move all elements out of deque in direct order
+   * @tparam outputIter type of output iterator
+   * @param[in] out output iterator to move elements to
+   * @returns output iterator after the last written element
+   */
+  template <typename outputIter>
+  outputIter DrainTo(outputIter out) {
+    return PopFrontN(size, out);
+  }
+
+  /**
+   * Method to move all elements out of deque in reverse order
+   * @tparam outputIter type of output iterator
+   * @param[in] out output iterator to move elements to
+   * @returns output iterator after the last written element
+   */
+  template <typename outputIter>
+  outputIter DrainBackTo(outputIter out) {
+    return PopBackN(size, out);
   }
 
   /**
@@ -675,8 +1411,18 @@ public:
    * @returns refernece on current deque
    */
   deque_t& AddOtherDeque(deque_t const& deque) {
-    for (auto& d : deque)
-      PushBack(d);
+    node_t* chainHead;
+    node_t* chainTail;
+
+    ReserveNodes(deque.size);
+
+    size_t count = CreateChain(deque.begin(), deque.end(), chainHead, chainTail);
+
+    if (count)
+      SpliceBack(chainHead, chainTail, count);
+
+    deque_stats_t::CountPush(false, count);
+    deque_stats_t::CountSize(size);
 
     return *this;
   }
@@ -687,14 +1433,20 @@ public:
    * @returns refernece on current deque
    */
   deque_t& AddOtherDeque(deque_t&& deque) {
+    if (this == &deque)
+      return *this;
+
     if (tail == nullptr) {
-      head = deque.head;
-      tail = deque.tail;
-      size = deque.size;
+      ReleaseSpares();
+      Allocator() = std::move(deque.Allocator());
+      Steal(deque);
+      CountMoved(true, false, size, size);
+    }
+    else if (!IsSameAllocator(Allocator(), deque.Allocator(), 0)) {
+      for (node_t* node = deque.head; node; node = node->next)
+        PushBack(std::move(node->value));
 
-      deque.head = nullptr;
-      deque.tail = nullptr;
-      deque.size = 0;
+      deque.Clear();
     }
     else {
       if (deque.head) {
@@ -702,7 +1454,9 @@ public:
         deque.head->prev = tail;
         tail = deque.tail;
         size += deque.size;
+        CountMoved(true, false, deque.size, size);
 
+        deque.ClearSkipIndex();
         deque.head = nullptr;
         deque.tail = nullptr;
         deque.size = 0;
@@ -712,12 +1466,539 @@ public:
     return *this;
   }
 
+  /**
+   * Method for moving all elements of another deque to the begin of the current one
+   *
+   * Nodes are relinked in constant time if the allocators are the same, otherwise elements are moved one by one
+   * @param[in] deque rvalue reference on other deque
+   * @returns refernece on current deque
+   */
+  deque_t& SpliceFront(deque_t&& deque) {
+    if (this == &deque)
+      return *this;
+
+    if (head == nullptr)
+      AddOtherDeque(std::move(deque));
+    else if (!IsSameAllocator(Allocator(), deque.Allocator(), 0)) {
+      for (node_t* node = deque.tail; node; node = node->prev)
+        PushFront(std::move(node->value));
+
+      deque.Clear();
+    }
+    else if (deque.head) {
+      SpliceFront(deque.head, deque.tail, deque.size);
+      CountMoved(true, true, deque.size, size);
+
+      deque.ClearSkipIndex();
+      deque.head = nullptr;
+      deque.tail = nullptr;
+      deque.size = 0;
+    }
+
+    return *this;
+  }
+
+  /**
+   * Method for splitting deque into two
+   *
+   * Nodes are relinked in constant time and counted in min(index, size - index) steps if a copy of the allocator
+   * is the same allocator (simple, arena and polymorphic allocators), otherwise elements are moved one by one
+   * @param[in] pos iterator to the first element of the suffix (end to split off nothing)
+   * @returns deque with elements from 'pos' to the end, current deque keeps elements before 'pos'
+   */
+  deque_t SplitAt(iterator pos) {
+    deque_t suffix(Allocator());
+    node_t* node = pos.curNode;
+
+    if (node == nullptr)
+      return suffix;
+
+    if (IsSameAllocator(Allocator(), suffix.Allocator(), 0)) {
+      size_t count = CountToEnd(node);
+
+      suffix.head = node;
+      suffix.tail = tail;
+      suffix.size = count;
+      ClearSkipIndex();
+      DetachBack(node->prev, count);
+      node->prev = nullptr;
+      CountMoved(false, false, count, count);
+    }
+    else {
+      size_t count = 0;
+
+      for (; node; node = node->next, count++)
+        suffix.PushBack(std::move(node->value));
+
+      for (; count; count--)
+        PopBack();
+    }
+
+    return suffix;
+  }
+
+  /**
+   * Method for moving elements of range of other deque before position in the current one
+   *
+   * Nodes are relinked if the allocators are the same, otherwise elements are moved one by one;
+   * the range is walked once to count its elements unless 'other' is the current deque
+   * @param[in] pos iterator to the element of current deque to put elements before (end to put them at the end)
+   * @param[in] other reference on deque to take elements from (may be the current deque if 'pos' is not in the range)
+   * @param[in] first iterator to the first element of range in 'other'
+   * @param[in] last iterator to the element after the last one of range in 'other'
+   */
+  void Splice(iterator pos, deque_t& other, iterator first, iterator last) {
+    node_t* chainHead = first.curNode;
+    node_t* chainTail = last.curNode ? last.curNode->prev : other.tail;
+
+    if (chainHead == last.curNode || (this == &other && (chainHead == pos.curNode || chainTail->next == pos.curNode)))
+      return;
+
+    if (!IsSameAllocator(Allocator(), other.Allocator(), 0)) {
+      bool fromFront = chainHead == other.head;
+      bool toFront = pos.curNode != nullptr && pos.curNode == head;
+      size_t count = 0;
+
+      for (node_t* node = chainHead; node != last.curNode; node = node->next, count++) {
+        node_t* copy = CreateNode(std::move(node->value));
+
+        LinkBefore(pos.curNode, copy, copy, 1);
+      }
+
+      CountMoved(fromFront, toFront, count, size);
+
+      for (node_t* node = chainHead; node != last.curNode;) {
+        node_t* next = node->next;
+
+        other.Unlink(node, node, 1);
+        other.DestroyNode(node);
+        node = next;
+      }
+
+      return;
+    }
+
+    size_t count = 0;
+
+    if (this != &other)
+      for (node_t* node = chainHead; node != last.curNode; node = node->next)
+        count++;
+
+    if (this != &other)
+      CountMoved(chainHead == other.head, pos.curNode != nullptr && pos.curNode == head, count, size + count);
+
+    other.Unlink(chainHead, chainTail, count);
+    LinkBefore(pos.curNode, chainHead, chainTail, count);
+  }
+
+  /**
+   * Method for merging elements of another sorted deque into the current sorted one
+   *
+   * Runs of nodes are relinked into place without allocation if the allocators are the same, otherwise elements
+   * are moved one by one; O(n + m) comparisons, equal elements of the current deque stay before those of 'deque'
+   * @tparam compare type of comparison called as comp(elemType const&, elemType const&)
+   * @param[in] deque rvalue reference on other deque sorted by 'comp' (empty after the call)
+   * @param[in] comp comparison both deques are sorted by
+   * @returns reference on current deque
+   */
+  template <typename compare = std::less<>>
+  deque_t& MergeSorted(deque_t&& deque, compare const& comp = compare()) {
+    if (this == &deque)
+      return *this;
+
+    if (head == nullptr)
+      return AddOtherDeque(std::move(deque));
+
+    node_t* pos = head;
+
+    if (!IsSameAllocator(Allocator(), deque.Allocator(), 0)) {
+      for (node_t* node = deque.head; node; node = node->next) {
+        while (pos && !comp(node->value, pos->value))
+          pos = pos->next;
+
+        node_t* copy = CreateNode(std::move(node->value));
+
+        deque_stats_t::CountPush(pos == head);
+        LinkBefore(pos, copy, copy, 1);
+      }
+
+      deque_stats_t::CountSize(size);
+      deque.Clear();
+      return *this;
+    }
+
+    while (node_t* runHead = deque.head) {
+      while (pos && !comp(runHead->value, pos->value))
+        pos = pos->next;
+
+      if (pos == nullptr)
+        return AddOtherDeque(std::move(deque));
+
+      node_t* runTail = runHead;
+      size_t count = 1;
+
+      for (; runTail->next && comp(runTail->next->value, pos->value); count++)
+        runTail = runTail->next;
+
+      CountMoved(true, pos == head, count, size + count);
+      deque.Unlink(runHead, runTail, count);
+      LinkBefore(pos, runHead, runTail, count);
+    }
+
+    return *this;
+  }
+
+  /**
+   * Method to put element into sorted deque after all elements equal to it (copy semantics)
+   *
+   * Positions near the tail are found in O(1), others by the skip index in O(log n + skipStep);
+   * the index is built by the first such search, kept while elements are popped from the ends and dropped when nodes
+   * leave the middle
+   * @tparam compare type of comparison called as comp(elemType const&, elemType const&)
+   * @param[in] elem const reference on element
+   * @param[in] comp comparison the deque is sorted by
+   * @returns reference on inserted element
+   */
+  template <typename compare = std::less<>>
+  elemType& InsertSorted(elemType const& elem, compare const& comp = compare()) {
+    node_t* pos = FindSortedPos(elem, comp);
+    node_t* node = CreateNode(elem);
+
+    deque_stats_t::CountPush(pos != nullptr && pos == head);
+    LinkBefore(pos, node, node, 1);
+    deque_stats_t::CountSize(size);
+
+    return node->value;
+  }
+
+  /**
+   * Method to put element into sorted deque after all elements equal to it (move semantics)
+   * @tparam compare type of comparison called as comp(elemType const&, elemType const&)
+   * @param[in] elem rvalue reference on element
+   * @param[in] comp comparison the deque is sorted by
+   * @returns reference on inserted element
+   */
+  template <typename compare = std::less<>>
+  elemType& InsertSorted(elemType&& elem, compare const& comp = compare()) {
+    node_t* pos = FindSortedPos(elem, comp);
+    node_t* node = CreateNode(std::move(elem));
+
+    deque_stats_t::CountPush(pos != nullptr && pos == head);
+    LinkBefore(pos, node, node, 1);
+    deque_stats_t::CountSize(size);
+
+    return node->value;
+  }
+
+  /**
+   * Get allocator method
+   * @return reference on the allocator used by deque
+   */
+  memoryAllocator& GetAllocator() noexcept {
+    return Allocator();
+  }
+
+  /**
+   * Method to pre-allocate nodes, so that 'front' + 'back' elements can be put without allocation
+   *
+   * Linked nodes do not depend on the end they are put at, so both counts share one spare list.
+   * Removed nodes are kept in the spare list up to the reserved number until ShrinkToFit is called
+   * @param[in] front number of elements expected to be put to begin of deque
+   * @param[in] back number of elements expected to be put to end of deque
+   */
+  void Reserve(size_t front, size_t back) {
+    size_t count = front + back;
+
+    spareLimit = std::max(spareLimit, count);
+    ReserveNodes(count - std::min(count, spareCount));
+
+    while (spareCount < count) {
+      node_t* node = (node_t*)AllocAligned<alignof(node_t)>(Allocator(), sizeof(node_t));
+
+      deque_stats_t::CountAlloc(NodeSize());
+      node->next = spare;
+      spare = node;
+      spareCount++;
+    }
+  }
+
+  /**
+   * Method to return all spare nodes to the allocator and stop keeping removed nodes
+   */
+  void ShrinkToFit() noexcept {
+    spareLimit = 0;
+    ReleaseSpares();
+  }
+
+  /**
+   * Get deque capacity method
+   * @return number of elements the deque can hold without allocation
+   */
+  size_t Capacity() const noexcept {
+    return size + spareCount;
+  }
+
+  /**
+   * Check links of deque method (walks all nodes, intended for stress tests and debugging)
+   * @return true if links of nodes agree with each other and with head, tail, size, spare list and skip index
+   */
+  bool IsConsistent() const noexcept {
+    if ((head == nullptr) != (tail == nullptr) || (head && (head->prev || tail->next)))
+      return false;
+
+    node_t const* prev = nullptr;
+    size_t count = 0;
+    size_t anchors = 0;
+
+    for (node_t const* node = head; node; prev = node, node = node->next, count++) {
+      if (node->prev != prev || count == size)
+        return false;
+
+      if (skipIndex && anchors < skipIndex->size() && (*skipIndex)[anchors] == node)
+        anchors++;
+    }
+
+    if (prev != tail || count != size || anchors != (skipIndex ? skipIndex->size() : 0))
+      return false;
+
+    count = 0;
+
+    for (node_t const* node = spare; node && count <= spareCount; node = node->next)
+      count++;
+
+    return count == spareCount && spareCount <= spareLimit;
+  }
+
+  /**
+   * Get node size method
+   * @return number of bytes requested from the allocator for one element
+   */
+  static constexpr size_t NodeSize() noexcept {
+    return AlignedAllocSize<alignof(node_t), memoryAllocator>(sizeof(node_t));
+  }
+
+  /**
+   * Method to call function for every element in parallel
+   *
+   * Elements are split into contiguous segments of about equal size, each segment is processed by its own thread.
+   * Bounds of segments are taken from the skip index, which is built here if it does not fit and kept while elements
+   * are added or popped from the ends
+   * @tparam func type of function called as func(elemType&), must be safe to call for different elements at once
+   * @param[in] f function to call
+   * @param[in] threadCount maximum number of threads (0 to use all hardware threads)
+   */
+  template <typename func>
+  void ForEach(func const& f, unsigned threadCount = 0) {
+    size_t segments = size ? ParallelSegmentCount(size, threadCount) : 0;
+
+    if (!SkipIndexFits(segments))
+      BuildSkipIndex();
+
+    std::vector<node_t*> bounds = SegmentBounds(segments);
+
+    RunParallelSegments(segments, [&](size_t segment) {
+      for (node_t* node = bounds[segment]; node != bounds[segment + 1]; node = node->next)
+        f(node->value);
+    });
+  }
+
+  /**
+   * Method to call function for every element with execution policy
+   * @tparam policy type of execution policy (sequenced policy runs in the calling thread)
+   * @tparam func type of function called as func(elemType&)
+   * @param[in] f function to call
+   */
+  template <typename policy, typename func> requires std::is_execution_policy_v<std::remove_cvref_t<policy>>
+  void ForEach(policy&&, func const& f) {
+    ForEach(f, PolicyThreadCount<policy>());
+  }
+
+  /**
+   * Method to replace every element by the result of function in parallel
+   * @tparam func type of function called as func(elemType const&), must be safe to call for different elements at once
+   * @param[in] f function to call
+   * @param[in] threadCount maximum number of threads (0 to use all hardware threads)
+   */
+  template <typename func>
+  void Transform(func const& f, unsigned threadCount = 0) {
+    ForEach([&](elemType& elem) { elem = f(std::as_const(elem)); }, threadCount);
+  }
+
+  /**
+   * Method to replace every element by the result of function with execution policy
+   * @tparam policy type of execution policy (sequenced policy runs in the calling thread)
+   * @tparam func type of function called as func(elemType const&)
+   * @param[in] f function to call
+   */
+  template <typename policy, typename func> requires std::is_execution_policy_v<std::remove_cvref_t<policy>>
+  void Transform(policy&&, func const& f) {
+    Transform(f, PolicyThreadCount<policy>());
+  }
+
+  /**
+   * Method to reduce elements in parallel
+   *
+   * Every segment is reduced by its own thread, then partial results are combined with 'init' in segment order.
+   * The skip index is only read: if it does not fit (ForEach and InsertSorted build it), bounds of segments
+   * are found by one walk over the list, so concurrent calls on a shared deque are safe
+   * @tparam type type of result (constructible from elemType)
+   * @tparam binaryOp type of associative operation called as op(type, elemType const&) and op(type, type)
+   * @param[in] init initial value
+   * @param[in] op operation
+   * @param[in] threadCount maximum number of threads (0 to use all hardware threads)
+   * @return reduced value ('init' if deque is empty)
+   */
+  template <typename type, typename binaryOp>
+  type Reduce(type init, binaryOp const& op, unsigned threadCount = 0) const {
+    size_t segments = size ? ParallelSegmentCount(size, threadCount) : 0;
+    std::vector<node_t*> bounds = SegmentBounds(segments);
+    std::vector<std::optional<type>> partials(segments);
+
+    RunParallelSegments(segments, [&](size_t segment) {
+      node_t const* node = bounds[segment];
+      type acc(node->value);
+
+      for (node = node->next; node != bounds[segment + 1]; node = node->next)
+        acc = op(std::move(acc), node->value);
+      partials[segment] = std::move(acc);
+    });
+
+    for (auto& p : partials)
+      init = op(std::move(init), std::move(*p));
+
+    return init;
+  }
+
+  /**
+   * Method to reduce elements with execution policy
+   * @tparam policy type of execution policy (sequenced policy runs in the calling thread)
+   * @tparam type type of result (constructible from elemType)
+   * @tparam binaryOp type of associative operation
+   * @param[in] init initial value
+   * @param[in] op operation
+   * @return reduced value ('init' if deque is empty)
+   */
+  template <typename policy, typename type, typename binaryOp> requires std::is_execution_policy_v<std::remove_cvref_t<policy>>
+  type Reduce(policy&&, type init, binaryOp const& op) const {
+    return Reduce(std::move(init), op, PolicyThreadCount<policy>());
+  }
+
+  /**
+   * Write elements to stream through a buffer without flushing the stream
+   * @param[in] stream output stream
+   * @param[in] separator string written after every element
+   * @return reference to stream
+   */
+  std::ostream& WriteTo(std::ostream& stream, std::string_view separator = " ") const {
+    stream_writer_t writer(stream);
+
+    for (node_t const* node = head; node; node = node->next) {
+      writer.Put(node->value);
+      writer.Write(separator);
+    }
+
+    writer.Flush();
+
+    return stream;
+  }
+
+  /**
+   * Write elements to stream in binary snapshot format (header followed by raw elements, written in large chunks)
+   * @param[in] stream output binary stream
+   * @exception "Failed to write snapshot" if the stream fails
+   * @see snapshot_header_t
+   */
+  void Serialize(std::ostream& stream) const requires std::is_trivially_copyable_v<elemType> {
+    snapshot_header_t header = MakeSnapshotHeader(sizeof(elemType), size);
+
+    stream.write((char const*)&header, sizeof(header));
+
+    {
+      stream_writer_t writer(stream);
+
+      for (node_t const* node = head; node; node = node->next)
+        writer.Write(std::string_view((char const*)&node->value, sizeof(elemType)));
+
+      writer.Flush();
+    }
+
+    if (!stream)
+      throw exception("Failed to write snapshot");
+  }
+
+  /**
+   * Replace elements with elements read from stream in binary snapshot format
+   *
+   * Nodes are reserved chunk by chunk as data arrives, so the count in the header is never trusted for allocation;
+   * if reading fails, the deque is not changed
+   * @param[in] stream input binary stream
+   * @exception "Snapshot is truncated" if the stream ends before the snapshot does
+   * @see CheckSnapshotHeader
+   */
+  void Deserialize(std::istream& stream) requires std::is_trivially_copyable_v<elemType> {
+    uint64_t count = ReadSnapshotHeader(stream, sizeof(elemType));
+    node_t* loadedHead = nullptr;
+    node_t* loadedTail = nullptr;
+    size_t loaded = 0;
+
+    try {
+      ReadSnapshotPayload<elemType>(stream, count, [&](elemType const* from, elemType const* to) {
+        node_t* chainHead;
+        node_t* chainTail;
+
+        ReserveNodes((size_t)(to - from));
+        loaded += CreateChain(from, to, chainHead, chainTail);
+
+        if (chainHead == nullptr)
+          return;
+
+        if (loadedTail) {
+          loadedTail->next = chainHead;
+          chainHead->prev = loadedTail;
+        }
+        else
+          loadedHead = chainHead;
+
+        loadedTail = chainTail;
+      });
+    }
+    catch (...) {
+      while (loadedHead) {
+        node_t* tmp = loadedHead;
+
+        loadedHead = loadedHead->next;
+        DestroyNode(tmp);
+      }
+
+      throw;
+    }
+
+    Clear();
+
+    if (loaded)
+      SpliceBack(loadedHead, loadedTail, loaded);
+
+    deque_stats_t::CountPush(false, loaded);
+    deque_stats_t::CountSize(size);
+  }
+
   /**
    * Clear deque
+   *
+   * If elements are trivially destructible and the allocator releases memory in bulk, nodes are dropped without walking them
    */
   void Clear(void) {
-    while (head)
-      PopBack();
+    if constexpr (std::is_trivially_destructible_v<elemType> && bulk_release_allocator<memoryAllocator>) {
+      deque_stats_t::CountPop(false, size);
+      deque_stats_t::CountDealloc(size * NodeSize(), size);
+      ClearSkipIndex();
+      head = nullptr;
+      tail = nullptr;
+      size = 0;
+    }
+    else
+      while (head)
+        PopBack();
   }
 
   /**
@@ -725,21 +2006,19 @@ public:
    */
   ~deque_t() {
     Clear();
+    ReleaseSpares();
   }
 };
 
 /**
- * Operator<< for deque
+ * Operator<< for deque (elements are separated by spaces and followed by a new line, the stream is not flushed)
  * @tparam type type of deque elements
+ * @tparam memoryAllocator the allocator used by deque
  * @param[in] stream output stream
  * @param[in] deque deque to output
  * @return reference to stream
  */
-template <typename type>
-std::ostream& operator<<(std::ostream& stream, deque_t<type> const& deque) {
-  for (auto& d : deque)
-    std::cout << d << " ";
-  std::cout << std::endl;
-  
-  return stream;
+template <typename type, typename memoryAllocator>
+std::ostream& operator<<(std::ostream& stream, deque_t<type, memoryAllocator> const& deque) {
+  return deque.WriteTo(stream) << '\n';
 }
\ No newline at end of file
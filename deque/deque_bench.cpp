@@ -0,0 +1,499 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <string>
+#include <vector>
+#include <numeric>
+#include "deque.h"
+#include "block_deque.h"
+#include "small_deque.h"
+#include "compact_deque.h"
+#include "concurrent_deque.h"
+#include "numa_allocator.h"
+
+/**
+ * @brief 64-byte POD element
+ */
+struct pod64_t {
+  int64_t data[8];   ///< payload
+};
+
+/**
+ * Build benchmark value
+ * @tparam elemType type of value
+ * @param[in] i value seed
+ * @return value
+ */
+template <typename elemType>
+static elemType MakeValue(int64_t i) {
+  if constexpr (std::is_same_v<elemType, std::string>)
+    return std::string(32, char('a' + i % 26));
+  else if constexpr (std::is_same_v<elemType, pod64_t>)
+    return pod64_t{ { i, i, i, i, i, i, i, i } };
+  else
+    return (elemType)i;
+}
+
+/**
+ * Get numeric weight of value (keeps iteration from being optimized out)
+ * @tparam elemType type of value
+ * @param[in] value value
+ * @return weight
+ */
+template <typename elemType>
+static int64_t Weight(elemType const& value) {
+  if constexpr (std::is_same_v<elemType, std::string>)
+    return (int64_t)value.size();
+  else if constexpr (std::is_same_v<elemType, pod64_t>)
+    return value.data[0];
+  else
+    return (int64_t)value;
+}
+
+/**
+ * Put element to end of container
+ */
+template <typename container, typename elemType>
+static void PushBack(container& c, elemType const& value) {
+  if constexpr (requires { c.PushBack(value); })
+    c.PushBack(value);
+  else
+    c.push_back(value);
+}
+
+/**
+ * Put element to begin of container
+ */
+template <typename container, typename elemType>
+static void PushFront(container& c, elemType const& value) {
+  if constexpr (requires { c.PushFront(value); })
+    c.PushFront(value);
+  else
+    c.push_front(value);
+}
+
+/**
+ * Remove first element of container
+ */
+template <typename container>
+static void PopFront(container& c) {
+  if constexpr (requires { c.PopFront(); })
+    c.PopFront();
+  else
+    c.pop_front();
+}
+
+/**
+ * Remove last element of container
+ */
+template <typename container>
+static void PopBack(container& c) {
+  if constexpr (requires { c.PopBack(); })
+    c.PopBack();
+  else
+    c.pop_back();
+}
+
+/**
+ * Append copy of other container to the end of container
+ */
+template <typename container>
+static void Append(container& c, container const& other) {
+  if constexpr (requires { c.AddOtherDeque(other); })
+    c.AddOtherDeque(other);
+  else
+    c.insert(c.end(), other.begin(), other.end());
+}
+
+/**
+ * Build container of 'count' elements
+ */
+template <typename container>
+static container Filled(int64_t count) {
+  using elemType = typename container::value_type;
+  container c;
+
+  for (int64_t i = 0; i < count; i++)
+    PushBack(c, MakeValue<elemType>(i));
+
+  return c;
+}
+
+/**
+ * @brief Container with value_type
+ *
+ * Adds value_type to deques of this repository so benchmarks can treat all containers alike
+ */
+template <typename container, typename elemType>
+struct bench_container_t : container {
+  using value_type = elemType;
+  using container::container;
+};
+
+template <typename elemType>
+using simple_deque = bench_container_t<deque_t<elemType>, elemType>;
+template <typename elemType>
+using pool_deque = bench_container_t<deque_t<elemType, pool_allocator_t>, elemType>;
+template <typename elemType>
+using arena_deque = bench_container_t<deque_t<elemType, arena_allocator_t>, elemType>;
+template <typename elemType>
+using polymorphic_deque = bench_container_t<deque_t<elemType, polymorphic_allocator_t>, elemType>;
+template <typename elemType>
+using block_deque = bench_container_t<block_deque_t<elemType>, elemType>;
+template <typename elemType>
+using arena_block_deque = bench_container_t<block_deque_t<elemType, arena_allocator_t>, elemType>;
+template <typename elemType>
+using pool_block_deque = bench_container_t<block_deque_t<elemType, pool_allocator_t>, elemType>;
+template <typename elemType>
+using magazine_deque = bench_container_t<deque_t<elemType, magazine_allocator_t>, elemType>;
+template <typename elemType>
+using numa_deque = bench_container_t<deque_t<elemType, numa_allocator_t>, elemType>;
+template <typename elemType>
+using small_deque = bench_container_t<small_deque_t<elemType, 8>, elemType>;
+template <typename elemType>
+using compact_deque = bench_container_t<compact_deque_t<elemType>, elemType>;
+
+template <typename container>
+static void BM_PushBack(benchmark::State& state) {
+  using elemType = typename container::value_type;
+  elemType value = MakeValue<elemType>(1);
+
+  for (auto _ : state) {
+    container c;
+
+    for (int64_t i = 0; i < state.range(0); i++)
+      PushBack(c, value);
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename container>
+static void BM_PushFront(benchmark::State& state) {
+  using elemType = typename container::value_type;
+  elemType value = MakeValue<elemType>(1);
+
+  for (auto _ : state) {
+    container c;
+
+    for (int64_t i = 0; i < state.range(0); i++)
+      PushFront(c, value);
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename container>
+static void BM_PushBackPopFront(benchmark::State& state) {
+  using elemType = typename container::value_type;
+  elemType value = MakeValue<elemType>(1);
+
+  for (auto _ : state) {
+    container c;
+
+    for (int64_t i = 0; i < state.range(0); i++)
+      PushBack(c, value);
+    for (int64_t i = 0; i < state.range(0); i++)
+      PopFront(c);
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+
+template <typename container>
+static void BM_PushFrontPopBack(benchmark::State& state) {
+  using elemType = typename container::value_type;
+  elemType value = MakeValue<elemType>(1);
+
+  for (auto _ : state) {
+    container c;
+
+    for (int64_t i = 0; i < state.range(0); i++)
+      PushFront(c, value);
+    for (int64_t i = 0; i < state.range(0); i++)
+      PopBack(c);
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * 2);
+}
+
+template <typename container>
+static void BM_Iterate(benchmark::State& state) {
+  container const c = Filled<container>(state.range(0));
+
+  for (auto _ : state) {
+    int64_t sum = 0;
+
+    for (auto& value : c)
+      sum += Weight(value);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename container>
+static void BM_CopyConstruct(benchmark::State& state) {
+  container const c = Filled<container>(state.range(0));
+
+  for (auto _ : state) {
+    container copy(c);
+
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename container>
+static void BM_CopyAssign(benchmark::State& state) {
+  container const c = Filled<container>(state.range(0));
+  container copy = Filled<container>(state.range(0));
+
+  for (auto _ : state) {
+    copy = c;
+
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename container>
+static void BM_AddOtherDeque(benchmark::State& state) {
+  container const other = Filled<container>(state.range(0));
+
+  for (auto _ : state) {
+    container c;
+
+    Append(c, other);
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename container>
+static void BM_MixedChurn(benchmark::State& state) {
+  using elemType = typename container::value_type;
+  container c = Filled<container>(state.range(0));
+  elemType value = MakeValue<elemType>(1);
+  uint32_t seed = 12345;
+
+  for (auto _ : state) {
+    seed = seed * 1664525 + 1013904223;
+    switch (seed >> 29) {
+    case 0: case 1: case 2:
+      PushBack(c, value);
+      PopFront(c);
+      break;
+    case 3: case 4:
+      PushFront(c, value);
+      PopBack(c);
+      break;
+    case 5:
+      PushBack(c, value);
+      PushFront(c, value);
+      PopFront(c);
+      PopBack(c);
+      break;
+    default:
+      PushFront(c, value);
+      PopFront(c);
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * Build and drop many short-lived deques of 'range(0)' elements (sizes typical for small_deque_t)
+ */
+template <typename container>
+static void BM_ShortLived(benchmark::State& state) {
+  using elemType = typename container::value_type;
+  elemType value = MakeValue<elemType>(1);
+
+  for (auto _ : state) {
+    container c;
+
+    for (int64_t i = 0; i < state.range(0); i++)
+      PushBack(c, value);
+    PopFront(c);
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+#define DEQUE_BENCH_CONTAINER(bm, container)                 \
+  BENCHMARK_TEMPLATE(bm, container<int>)->Arg(1 << 10)->Arg(1 << 16); \
+  BENCHMARK_TEMPLATE(bm, container<pod64_t>)->Arg(1 << 10)->Arg(1 << 16); \
+  BENCHMARK_TEMPLATE(bm, container<std::string>)->Arg(1 << 10)->Arg(1 << 16)
+
+#define DEQUE_BENCH(bm)                                 \
+  DEQUE_BENCH_CONTAINER(bm, simple_deque);              \
+  DEQUE_BENCH_CONTAINER(bm, pool_deque);                \
+  DEQUE_BENCH_CONTAINER(bm, magazine_deque);            \
+  DEQUE_BENCH_CONTAINER(bm, numa_deque);                \
+  DEQUE_BENCH_CONTAINER(bm, arena_deque);               \
+  DEQUE_BENCH_CONTAINER(bm, polymorphic_deque);         \
+  DEQUE_BENCH_CONTAINER(bm, block_deque);               \
+  DEQUE_BENCH_CONTAINER(bm, arena_block_deque);         \
+  DEQUE_BENCH_CONTAINER(bm, pool_block_deque);          \
+  DEQUE_BENCH_CONTAINER(bm, std::deque);                \
+  DEQUE_BENCH_CONTAINER(bm, std::list)
+
+DEQUE_BENCH(BM_PushBack);
+DEQUE_BENCH(BM_PushFront);
+DEQUE_BENCH(BM_PushBackPopFront);
+DEQUE_BENCH(BM_PushFrontPopBack);
+DEQUE_BENCH(BM_Iterate);
+DEQUE_BENCH(BM_CopyConstruct);
+DEQUE_BENCH(BM_CopyAssign);
+DEQUE_BENCH(BM_AddOtherDeque);
+DEQUE_BENCH(BM_MixedChurn);
+
+// compact_deque_t has no bulk append, so it skips BM_AddOtherDeque
+DEQUE_BENCH_CONTAINER(BM_PushBack, compact_deque);
+DEQUE_BENCH_CONTAINER(BM_PushFront, compact_deque);
+DEQUE_BENCH_CONTAINER(BM_PushBackPopFront, compact_deque);
+DEQUE_BENCH_CONTAINER(BM_PushFrontPopBack, compact_deque);
+DEQUE_BENCH_CONTAINER(BM_Iterate, compact_deque);
+DEQUE_BENCH_CONTAINER(BM_CopyConstruct, compact_deque);
+DEQUE_BENCH_CONTAINER(BM_CopyAssign, compact_deque);
+DEQUE_BENCH_CONTAINER(BM_MixedChurn, compact_deque);
+
+#define SHORT_LIVED_BENCH(container)                                              \
+  BENCHMARK_TEMPLATE(BM_ShortLived, container<int>)->Arg(4)->Arg(8)->Arg(16); \
+  BENCHMARK_TEMPLATE(BM_ShortLived, container<std::string>)->Arg(4)->Arg(8)->Arg(16)
+
+SHORT_LIVED_BENCH(simple_deque);
+SHORT_LIVED_BENCH(block_deque);
+SHORT_LIVED_BENCH(small_deque);
+SHORT_LIVED_BENCH(std::deque);
+SHORT_LIVED_BENCH(std::list);
+
+/**
+ * Producer/consumer benchmark: even threads push 'range(0)' elements per iteration, odd threads pop as many,
+ * so nodes are allocated and freed by different threads
+ */
+template <typename memoryAllocator>
+static void BM_CrossThread(benchmark::State& state) {
+  static concurrent_deque_t<int64_t, memoryAllocator> queue;
+  bool producer = state.thread_index() % 2 == 0;
+
+  for (auto _ : state)
+    for (int64_t i = 0; i < state.range(0); i++)
+      if (producer)
+        queue.PushBack(i);
+      else
+        while (!queue.TryPopFront())
+          ;
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_CrossThread, simple_allocator_t)->Arg(1 << 10)->ThreadRange(2, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_CrossThread, magazine_allocator_t)->Arg(1 << 10)->ThreadRange(2, 16)->UseRealTime();
+
+/**
+ * Build block deque of 'count' small numbers
+ */
+template <typename elemType>
+static block_deque_t<elemType> Numbers(int64_t count) {
+  block_deque_t<elemType> d;
+
+  for (int64_t i = 0; i < count; i++)
+    d.PushBack((elemType)(i % 1000));
+
+  return d;
+}
+
+/**
+ * Run bulk kernel benchmark with instruction set given by the first argument (0 - scalar, 1 - AVX2)
+ */
+template <typename elemType, typename func>
+static void RunKernel(benchmark::State& state, func const& kernel) {
+  block_deque_t<elemType> d = Numbers<elemType>(state.range(1));
+
+  SetSimdLevel((simd_level_t)state.range(0));
+  state.SetLabel(SimdLevel() == simd_level_t::avx2 ? "avx2" : "scalar");
+
+  for (auto _ : state)
+    kernel(d);
+
+  SetSimdLevel(DetectSimdLevel());
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+template <typename elemType>
+static void BM_Sum(benchmark::State& state) {
+  RunKernel<elemType>(state, [](block_deque_t<elemType>& d) { benchmark::DoNotOptimize(d.Sum()); });
+}
+
+template <typename elemType>
+static void BM_SumIterators(benchmark::State& state) {
+  RunKernel<elemType>(state, [](block_deque_t<elemType>& d) {
+    benchmark::DoNotOptimize(std::accumulate(d.begin(), d.end(), simd_sum_t<elemType>(0)));
+  });
+}
+
+template <typename elemType>
+static void BM_Min(benchmark::State& state) {
+  RunKernel<elemType>(state, [](block_deque_t<elemType>& d) { benchmark::DoNotOptimize(d.Min()); });
+}
+
+template <typename elemType>
+static void BM_Find(benchmark::State& state) {
+  RunKernel<elemType>(state, [](block_deque_t<elemType>& d) { benchmark::DoNotOptimize(d.Find((elemType)-1)); });
+}
+
+template <typename elemType>
+static void BM_Count(benchmark::State& state) {
+  RunKernel<elemType>(state, [](block_deque_t<elemType>& d) { benchmark::DoNotOptimize(d.Count((elemType)7)); });
+}
+
+template <typename elemType>
+static void BM_Fill(benchmark::State& state) {
+  RunKernel<elemType>(state, [](block_deque_t<elemType>& d) {
+    d.Fill((elemType)3);
+    benchmark::ClobberMemory();
+  });
+}
+
+#define KERNEL_BENCH(bm)                                                          \
+  BENCHMARK_TEMPLATE(bm, int32_t)->ArgsProduct({ { 0, 1 }, { 1 << 20 } });        \
+  BENCHMARK_TEMPLATE(bm, int64_t)->ArgsProduct({ { 0, 1 }, { 1 << 20 } });        \
+  BENCHMARK_TEMPLATE(bm, float)->ArgsProduct({ { 0, 1 }, { 1 << 20 } });          \
+  BENCHMARK_TEMPLATE(bm, double)->ArgsProduct({ { 0, 1 }, { 1 << 20 } })
+
+KERNEL_BENCH(BM_Sum);
+KERNEL_BENCH(BM_SumIterators);
+KERNEL_BENCH(BM_Min);
+KERNEL_BENCH(BM_Find);
+KERNEL_BENCH(BM_Count);
+KERNEL_BENCH(BM_Fill);
+
+/**
+ * Benchmark entry point (JSON output is used unless other format is requested)
+ */
+int main(int argc, char** argv) {
+  std::vector<char*> args(argv, argv + argc);
+  char jsonFormat[] = "--benchmark_format=json";
+  bool hasFormat = false;
+
+  for (int i = 1; i < argc; i++)
+    if (std::strncmp(argv[i], "--benchmark_format", 18) == 0)
+      hasFormat = true;
+
+  if (!hasFormat)
+    args.push_back(jsonFormat);
+
+  int count = (int)args.size();
+
+  benchmark::Initialize(&count, args.data());
+  if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+    return 1;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
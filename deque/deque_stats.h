@@ -0,0 +1,376 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string_view>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include "allocator_interface.h"
+
+/**
+ * Deque statistics policy
+ *
+ * If DEQUE_STATS is not 0, deque_t counts its operations, allocations and errors in process-wide counters
+ * read by deque_stats_t::Snapshot; otherwise the counting calls are compiled out. Off by default.
+ * The value must be the same in all translation units of a program
+ */
+#ifndef DEQUE_STATS
+#define DEQUE_STATS 0
+#endif
+
+/**
+ * True if deques collect statistics
+ */
+constexpr bool dequeStats = DEQUE_STATS != 0;
+
+/**
+ * @brief Deque statistics snapshot
+ *
+ * Values of process-wide deque counters at the moment of Snapshot call
+ */
+struct deque_stats_snapshot_t {
+  uint64_t pushFront;       ///< number of elements put to begin of deques
+  uint64_t pushBack;        ///< number of elements put to end of deques
+  uint64_t popFront;        ///< number of elements removed from begin of deques
+  uint64_t popBack;         ///< number of elements removed from end of deques
+  uint64_t allocations;     ///< number of allocator calls
+  uint64_t deallocations;   ///< number of deallocator calls (and nodes dropped by bulk release allocators)
+  uint64_t bytesLive;       ///< bytes allocated and not released
+  uint64_t bytesPeak;       ///< maximal value of 'bytesLive'
+  uint64_t maxSize;         ///< maximal size of a deque
+  uint64_t emptyErrors;     ///< number of "Deque is empty" exceptions
+};
+
+/**
+ * @brief Process-wide deque statistics
+ *
+ * Counters are updated with relaxed atomics, so values of different counters in a snapshot may be slightly out of sync.
+ * All counting methods do nothing unless DEQUE_STATS is set
+ */
+class deque_stats_t {
+private:
+  /**
+   * @brief Statistics counters
+   */
+  struct counters_t {
+    std::atomic<uint64_t> pushFront{ 0 };       ///< number of elements put to begin of deques
+    std::atomic<uint64_t> pushBack{ 0 };        ///< number of elements put to end of deques
+    std::atomic<uint64_t> popFront{ 0 };        ///< number of elements removed from begin of deques
+    std::atomic<uint64_t> popBack{ 0 };         ///< number of elements removed from end of deques
+    std::atomic<uint64_t> allocations{ 0 };     ///< number of allocator calls
+    std::atomic<uint64_t> deallocations{ 0 };   ///< number of deallocator calls
+    std::atomic<uint64_t> bytesLive{ 0 };       ///< bytes allocated and not released
+    std::atomic<uint64_t> bytesPeak{ 0 };       ///< maximal value of 'bytesLive'
+    std::atomic<uint64_t> maxSize{ 0 };         ///< maximal size of a deque
+    std::atomic<uint64_t> emptyErrors{ 0 };     ///< number of "Deque is empty" exceptions
+  };
+
+  /**
+   * Get counters method
+   * @return reference on the process-wide counters
+   */
+  static counters_t& Counters() noexcept {
+    static counters_t counters;
+
+    return counters;
+  }
+
+  /**
+   * Raise counter to value if it is smaller
+   * @param[in] counter counter to update
+   * @param[in] value new candidate value
+   */
+  static void UpdateMax(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+    uint64_t old = counter.load(std::memory_order_relaxed);
+
+    while (old < value && !counter.compare_exchange_weak(old, value, std::memory_order_relaxed))
+      ;
+  }
+public:
+  /**
+   * Count elements put to deque
+   * @param[in] front true if elements are put to begin, false if to end
+   * @param[in] count number of elements
+   */
+  static void CountPush(bool front, uint64_t count = 1) noexcept {
+    if constexpr (dequeStats)
+      (front ? Counters().pushFront : Counters().pushBack).fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /**
+   * Count elements removed from deque
+   * @param[in] front true if elements are removed from begin, false if from end
+   * @param[in] count number of elements
+   */
+  static void CountPop(bool front, uint64_t count = 1) noexcept {
+    if constexpr (dequeStats)
+      (front ? Counters().popFront : Counters().popBack).fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /**
+   * Count allocator call
+   * @param[in] bytes number of allocated bytes
+   */
+  static void CountAlloc(uint64_t bytes) noexcept {
+    if constexpr (dequeStats) {
+      counters_t& counters = Counters();
+
+      counters.allocations.fetch_add(1, std::memory_order_relaxed);
+      UpdateMax(counters.bytesPeak, counters.bytesLive.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+    }
+  }
+
+  /**
+   * Count released memory
+   * @param[in] bytes number of released bytes
+   * @param[in] count number of released blocks
+   */
+  static void CountDealloc(uint64_t bytes, uint64_t count = 1) noexcept {
+    if constexpr (dequeStats) {
+      Counters().deallocations.fetch_add(count, std::memory_order_relaxed);
+      Counters().bytesLive.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Count deque size for the high-water mark
+   * @param[in] size current size of a deque
+   */
+  static void CountSize(uint64_t size) noexcept {
+    if constexpr (dequeStats)
+      UpdateMax(Counters().maxSize, size);
+  }
+
+  /**
+   * Count "Deque is empty" exception
+   */
+  static void CountEmptyError() noexcept {
+    if constexpr (dequeStats)
+      Counters().emptyErrors.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Get statistics snapshot method
+   * @return current values of counters (all zero unless DEQUE_STATS is set)
+   */
+  static deque_stats_snapshot_t Snapshot() noexcept {
+    counters_t& counters = Counters();
+
+    return {
+      counters.pushFront.load(std::memory_order_relaxed),
+      counters.pushBack.load(std::memory_order_relaxed),
+      counters.popFront.load(std::memory_order_relaxed),
+      counters.popBack.load(std::memory_order_relaxed),
+      counters.allocations.load(std::memory_order_relaxed),
+      counters.deallocations.load(std::memory_order_relaxed),
+      counters.bytesLive.load(std::memory_order_relaxed),
+      counters.bytesPeak.load(std::memory_order_relaxed),
+      counters.maxSize.load(std::memory_order_relaxed),
+      counters.emptyErrors.load(std::memory_order_relaxed)
+    };
+  }
+
+  /**
+   * Reset counters of operations and high-water marks ('bytesLive' is kept, peak is set to it)
+   */
+  static void Reset() noexcept {
+    counters_t& counters = Counters();
+
+    counters.pushFront = 0;
+    counters.pushBack = 0;
+    counters.popFront = 0;
+    counters.popBack = 0;
+    counters.allocations = 0;
+    counters.deallocations = 0;
+    counters.bytesPeak = counters.bytesLive.load(std::memory_order_relaxed);
+    counters.maxSize = 0;
+    counters.emptyErrors = 0;
+  }
+};
+
+/**
+ * Number of buckets of latency histogram
+ */
+constexpr size_t latencyBuckets = 32;
+
+/**
+ * @brief Latency histogram snapshot
+ *
+ * Bucket 0 counts calls taking at most 1 ns, bucket i counts calls taking (2^(i-1), 2^i] ns,
+ * so 2^i is an inclusive upper bound like 'le' of Prometheus; the last bucket also counts all slower calls
+ */
+struct latency_histogram_t {
+  uint64_t counts[latencyBuckets];   ///< number of calls in every bucket
+  uint64_t count;                    ///< total number of calls
+  uint64_t sumNs;                    ///< total time of calls in nanoseconds
+};
+
+/**
+ * @brief Latency recording allocator
+ *
+ * Forwards requests to another allocator_interface_t and records latency histograms of alloc and dealloc calls.
+ * The histograms are updated with relaxed atomics, so the allocator is as thread-safe as the wrapped one
+ * @warning the wrapped allocator must outlive this one
+ */
+class stats_allocator_t : public allocator_interface_t {
+private:
+  /**
+   * @brief Histogram counters
+   */
+  struct histogram_t {
+    std::atomic<uint64_t> counts[latencyBuckets] = {};   ///< number of calls in every bucket
+    std::atomic<uint64_t> sumNs{ 0 };                     ///< total time of calls in nanoseconds
+
+    /**
+     * Record call
+     * @param[in] ns call latency in nanoseconds
+     */
+    void Record(uint64_t ns) noexcept {
+      counts[std::min<size_t>(std::bit_width(ns ? ns - 1 : 0), latencyBuckets - 1)].fetch_add(1, std::memory_order_relaxed);
+      sumNs.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get snapshot of histogram
+     * @return current values of counters
+     */
+    latency_histogram_t Snapshot() const noexcept {
+      latency_histogram_t snapshot = {};
+
+      for (size_t i = 0; i < latencyBuckets; i++) {
+        snapshot.counts[i] = counts[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.counts[i];
+      }
+      snapshot.sumNs = sumNs.load(std::memory_order_relaxed);
+
+      return snapshot;
+    }
+  };
+
+  using clock_t = std::chrono::steady_clock;
+
+  allocator_interface_t& allocator;   ///< wrapped allocator
+  histogram_t allocLatency;           ///< latency of alloc calls
+  histogram_t deallocLatency;         ///< latency of dealloc calls
+
+  /**
+   * Get nanoseconds passed since time point
+   * @param[in] start time point
+   * @return number of nanoseconds
+   */
+  static uint64_t Elapsed(clock_t::time_point start) noexcept {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count();
+  }
+public:
+  /**
+   * Constructor from allocator
+   * @param[in] allocator allocator to forward requests to
+   */
+  explicit stats_allocator_t(allocator_interface_t& allocator) : allocator(allocator) {}
+
+  stats_allocator_t(stats_allocator_t const&) = delete;
+  stats_allocator_t& operator=(stats_allocator_t const&) = delete;
+
+  /**
+   * A method that allocates a block of size 'size'
+   *
+   * @param[in] size number of bytes to allocate
+   * @return pointer to allocated memory
+   */
+  void* alloc(size_t size) override {
+    clock_t::time_point start = clock_t::now();
+    void* data = allocator.alloc(size);
+
+    allocLatency.Record(Elapsed(start));
+
+    return data;
+  }
+
+  /**
+   * Dealocation a block by pointer
+   *
+   * @param[in] data pointer to block
+   */
+  void dealloc(void* data) override {
+    clock_t::time_point start = clock_t::now();
+
+    allocator.dealloc(data);
+    deallocLatency.Record(Elapsed(start));
+  }
+
+  /**
+   * Get alloc latency histogram method
+   * @return snapshot of alloc latency histogram
+   */
+  latency_histogram_t AllocLatency() const noexcept {
+    return allocLatency.Snapshot();
+  }
+
+  /**
+   * Get dealloc latency histogram method
+   * @return snapshot of dealloc latency histogram
+   */
+  latency_histogram_t DeallocLatency() const noexcept {
+    return deallocLatency.Snapshot();
+  }
+};
+
+/**
+ * Write deque statistics in Prometheus text exposition format
+ * @param[in] stream output stream
+ * @param[in] stats statistics snapshot
+ * @param[in] prefix prefix of metric names
+ * @return reference to stream
+ */
+inline std::ostream& WritePrometheus(std::ostream& stream, deque_stats_snapshot_t const& stats, std::string_view prefix = "deque") {
+  struct metric_t {
+    char const* name;
+    char const* type;
+    uint64_t value;
+  } const metrics[] = {
+    { "_push_front_total", "counter", stats.pushFront },
+    { "_push_back_total", "counter", stats.pushBack },
+    { "_pop_front_total", "counter", stats.popFront },
+    { "_pop_back_total", "counter", stats.popBack },
+    { "_allocations_total", "counter", stats.allocations },
+    { "_deallocations_total", "counter", stats.deallocations },
+    { "_bytes_live", "gauge", stats.bytesLive },
+    { "_bytes_peak", "gauge", stats.bytesPeak },
+    { "_max_size", "gauge", stats.maxSize },
+    { "_empty_errors_total", "counter", stats.emptyErrors }
+  };
+
+  for (auto& m : metrics) {
+    stream << "# TYPE " << prefix << m.name << ' ' << m.type << '\n';
+    stream << prefix << m.name << ' ' << m.value << '\n';
+  }
+
+  return stream;
+}
+
+/**
+ * Write latency histogram in Prometheus text exposition format (bucket bounds are in seconds)
+ * @param[in] stream output stream
+ * @param[in] histogram histogram snapshot
+ * @param[in] name metric name
+ * @return reference to stream
+ */
+inline std::ostream& WritePrometheus(std::ostream& stream, latency_histogram_t const& histogram, std::string_view name) {
+  uint64_t cumulative = 0;
+
+  stream << "# TYPE " << name << " histogram\n";
+
+  for (size_t i = 0; i + 1 < latencyBuckets; i++) {
+    cumulative += histogram.counts[i];
+    stream << name << "_bucket{le=\"" << (double)(uint64_t(1) << i) * 1e-9 << "\"} " << cumulative << '\n';
+  }
+
+  stream << name << "_bucket{le=\"+Inf\"} " << histogram.count << '\n';
+  stream << name << "_sum " << (double)histogram.sumNs * 1e-9 << '\n';
+  stream << name << "_count " << histogram.count << '\n';
+
+  return stream;
+}
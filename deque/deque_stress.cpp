@@ -0,0 +1,716 @@
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "deque.h"
+#include "concurrent_deque.h"
+#include "sharded_deque.h"
+#include "async_deque.h"
+
+using clock_type = std::chrono::steady_clock;
+
+/**
+ * @brief HDR latency histogram
+ *
+ * High dynamic range histogram of nanosecond values: values below 'subCount' are counted exactly,
+ * larger ones in log-linear buckets with 'subCount / 2' sub-buckets per power of two,
+ * so every recorded value is known with a relative error below 2 / 'subCount'
+ */
+class hdr_histogram_t {
+private:
+  static constexpr unsigned subBits = 7;                          ///< number of bits of sub-bucket index
+  static constexpr uint64_t subCount = uint64_t(1) << subBits;    ///< number of exactly counted values
+  static constexpr uint64_t halfCount = subCount / 2;             ///< number of sub-buckets per power of two
+
+  std::vector<uint64_t> counts;   ///< number of values in every bucket
+  uint64_t total;                 ///< number of recorded values
+  uint64_t max;                   ///< maximal recorded value
+
+  /**
+   * Get bucket of value
+   * @param[in] value value in nanoseconds
+   * @return index of bucket
+   */
+  static size_t Index(uint64_t value) noexcept {
+    if (value < subCount)
+      return (size_t)value;
+
+    unsigned shift = (unsigned)std::bit_width(value) - subBits;
+
+    return (size_t)(subCount + (shift - 1) * halfCount + ((value >> shift) - halfCount));
+  }
+
+  /**
+   * Get highest value of bucket
+   * @param[in] index index of bucket
+   * @return highest value counted in the bucket
+   */
+  static uint64_t HighestValue(size_t index) noexcept {
+    if (index < subCount)
+      return index;
+
+    unsigned shift = (unsigned)((index - subCount) / halfCount) + 1;
+    uint64_t sub = (index - subCount) % halfCount + halfCount;
+
+    return ((sub + 1) << shift) - 1;
+  }
+public:
+  /**
+   * Empty histogram constructor
+   */
+  hdr_histogram_t() : counts(Index(UINT64_MAX) + 1), total(0), max(0) {}
+
+  /**
+   * Record value
+   * @param[in] value value in nanoseconds
+   */
+  void Record(uint64_t value) noexcept {
+    counts[Index(value)]++;
+    total++;
+    max = std::max(max, value);
+  }
+
+  /**
+   * Add values of other histogram
+   * @param[in] histogram histogram to add
+   */
+  void Merge(hdr_histogram_t const& histogram) noexcept {
+    for (size_t i = 0; i < counts.size(); i++)
+      counts[i] += histogram.counts[i];
+
+    total += histogram.total;
+    max = std::max(max, histogram.max);
+  }
+
+  /**
+   * Get number of recorded values
+   * @return number of values
+   */
+  uint64_t Count() const noexcept {
+    return total;
+  }
+
+  /**
+   * Get maximal recorded value
+   * @return maximal value (0 if the histogram is empty)
+   */
+  uint64_t Max() const noexcept {
+    return max;
+  }
+
+  /**
+   * Get percentile
+   * @param[in] percent percentile in (0, 100]
+   * @return highest value of the bucket holding the percentile (0 if the histogram is empty)
+   */
+  uint64_t Percentile(double percent) const noexcept {
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)((double)total * percent / 100.0 + 0.5));
+    uint64_t cumulative = 0;
+
+    for (size_t i = 0; i < counts.size(); i++) {
+      cumulative += counts[i];
+
+      if (cumulative >= rank)
+        return std::min(HighestValue(i), max);
+    }
+
+    return max;
+  }
+};
+
+/**
+ * @brief Deque operations recorded by the harness
+ */
+enum class op_t {
+  pushBack,
+  pushFront,
+  popFront,
+  popBack
+};
+
+constexpr size_t opCount = 4;                                                  ///< number of operations
+constexpr char const* opNames[opCount] = { "PushBack", "PushFront", "PopFront", "PopBack" };   ///< names of operations
+
+/**
+ * @brief Workload mix
+ *
+ * Weights of operations and bursts: before every operation a burst of 'burstLength' equal operations
+ * is started with probability 1 / 'burstPeriod'
+ */
+struct workload_t {
+  unsigned weights[opCount] = { 70, 0, 30, 0 };   ///< relative weights of operations
+  size_t burstLength = 256;                       ///< number of operations in burst (0 disables bursts)
+  size_t burstPeriod = 1024;                      ///< mean number of operations between bursts
+
+  /**
+   * Check is workload FIFO method
+   * @return true if elements are only put to the end and taken from the begin
+   */
+  bool IsFifo() const noexcept {
+    return weights[(size_t)op_t::pushFront] == 0 && weights[(size_t)op_t::popBack] == 0;
+  }
+};
+
+/**
+ * @brief Harness options
+ */
+struct stress_config_t {
+  workload_t workload;        ///< mix of operations
+  size_t ops = 1000000;       ///< number of operations per deque (split between threads for concurrent deques)
+  unsigned threads = 4;       ///< number of threads for concurrent deques
+  size_t checkEvery = 4096;   ///< number of operations between invariant checks of sequential deques
+  uint64_t seed = 1;          ///< seed of operation streams
+  std::string only;           ///< run only deques with names containing this string (all if empty)
+};
+
+/**
+ * @brief Operation stream
+ *
+ * Pseudo-random sequence of operations following the workload mix
+ */
+class op_stream_t {
+private:
+  workload_t const& workload;   ///< mix of operations
+  uint64_t state;               ///< splitmix64 state
+  unsigned weightSum;           ///< sum of operation weights
+  size_t burstLeft;             ///< number of operations left in the current burst
+  op_t burstOp;                 ///< operation of the current burst
+
+  /**
+   * Get next pseudo-random number
+   * @return random number
+   */
+  uint64_t Random() noexcept {
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+
+    return z ^ (z >> 31);
+  }
+
+  /**
+   * Get operation by weights
+   * @return random operation
+   */
+  op_t Pick() noexcept {
+    uint64_t value = Random() % weightSum;
+    size_t i = 0;
+
+    for (; value >= workload.weights[i]; i++)
+      value -= workload.weights[i];
+
+    return (op_t)i;
+  }
+public:
+  /**
+   * Operation stream constructor
+   * @param[in] workload mix of operations (at least one weight must be positive)
+   * @param[in] seed seed of the stream
+   */
+  op_stream_t(workload_t const& workload, uint64_t seed) : workload(workload), state(seed), weightSum(0), burstLeft(0), burstOp(op_t::pushBack) {
+    for (unsigned weight : workload.weights)
+      weightSum += weight;
+  }
+
+  /**
+   * Get next operation
+   * @return operation to run
+   */
+  op_t Next() noexcept {
+    if (burstLeft) {
+      burstLeft--;
+      return burstOp;
+    }
+
+    op_t op = Pick();
+
+    if (workload.burstLength && Random() % workload.burstPeriod == 0) {
+      burstOp = op;
+      burstLeft = workload.burstLength - 1;
+    }
+
+    return op;
+  }
+};
+
+/**
+ * @brief Latencies of all operations
+ */
+struct op_latency_t {
+  hdr_histogram_t ops[opCount];   ///< latency histogram of every operation
+  uint64_t emptyPops = 0;         ///< number of pops from empty deque
+
+  /**
+   * Add latencies of other thread
+   * @param[in] latency latencies to add
+   */
+  void Merge(op_latency_t const& latency) noexcept {
+    for (size_t i = 0; i < opCount; i++)
+      ops[i].Merge(latency.ops[i]);
+
+    emptyPops += latency.emptyPops;
+  }
+};
+
+/**
+ * Throw if condition does not hold
+ * @param[in] condition checked condition
+ * @param[in] name name of checked deque
+ * @param[in] message description of broken invariant
+ * @exception exception invariant is broken
+ */
+static void Check(bool condition, std::string_view name, std::string_view message) {
+  if (!condition)
+    throw exception((std::string(name) + ": " + std::string(message)).c_str());
+}
+
+/**
+ * Get nanoseconds passed since time point
+ * @param[in] start time point
+ * @return number of nanoseconds
+ */
+static uint64_t Elapsed(clock_type::time_point start) noexcept {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+}
+
+/**
+ * Measure the cost of reading the clock (it is included in every recorded latency)
+ * @return minimal time between two clock reads in nanoseconds
+ */
+static uint64_t ClockOverhead() {
+  uint64_t best = UINT64_MAX;
+
+  for (int i = 0; i < 10000; i++)
+    best = std::min(best, Elapsed(clock_type::now()));
+
+  return best;
+}
+
+/**
+ * Put element to deque
+ * @tparam container type of deque
+ * @param[in] deque deque to put element to
+ * @param[in] front true to put element to begin, false to put it to end
+ * @param[in] value element
+ */
+template <typename container>
+static void Push(container& deque, bool front, uint64_t value) {
+  if constexpr (requires { deque.TryPushBack(value); })
+    deque.TryPushBack(value);   // async_deque_t is a FIFO queue, it is run with FIFO workloads only
+  else if (front)
+    deque.PushFront(value);
+  else
+    deque.PushBack(value);
+}
+
+/**
+ * Take element from deque
+ * @tparam container type of deque
+ * @param[in] deque deque to take element from
+ * @param[in] front true to take the first element, false to take the last one
+ * @returns element or std::nullopt if deque is empty
+ */
+template <typename container>
+static std::optional<uint64_t> Pop(container& deque, bool front) {
+  if constexpr (requires { deque.TryPopBack(); })
+    return front ? deque.TryPopFront() : deque.TryPopBack();
+  else
+    return deque.TryPopFront();
+}
+
+/**
+ * Print latency report
+ * @param[in] name name of deque
+ * @param[in] latency recorded latencies
+ * @param[in] ns wall time of the run in nanoseconds
+ */
+static void Report(std::string_view name, op_latency_t const& latency, uint64_t ns) {
+  uint64_t total = 0;
+
+  for (auto& histogram : latency.ops)
+    total += histogram.Count();
+
+  std::cout << name << ": " << total << " ops in " << std::fixed << std::setprecision(1) << (double)ns / 1e6 << " ms, "
+    << latency.emptyPops << " pops from empty deque\n";
+  std::cout << "  " << std::left << std::setw(10) << "op" << std::right << std::setw(10) << "count" << std::setw(8) << "p50"
+    << std::setw(8) << "p90" << std::setw(8) << "p99" << std::setw(8) << "p99.9" << std::setw(10) << "max" << "  (ns)\n";
+
+  for (size_t i = 0; i < opCount; i++) {
+    hdr_histogram_t const& histogram = latency.ops[i];
+
+    if (histogram.Count() == 0)
+      continue;
+
+    std::cout << "  " << std::left << std::setw(10) << opNames[i] << std::right << std::setw(10) << histogram.Count()
+      << std::setw(8) << histogram.Percentile(50) << std::setw(8) << histogram.Percentile(90) << std::setw(8) << histogram.Percentile(99)
+      << std::setw(8) << histogram.Percentile(99.9) << std::setw(10) << histogram.Max() << '\n';
+  }
+}
+
+/**
+ * Check deque against reference model
+ * @tparam container type of deque
+ * @param[in] name name of deque
+ * @param[in] deque checked deque
+ * @param[in] model elements the deque must hold
+ * @exception exception invariant is broken
+ */
+template <typename container>
+static void CheckInvariants(std::string_view name, container& deque, std::deque<uint64_t> const& model) {
+  if constexpr (requires { deque.IsConsistent(); })
+    Check(deque.IsConsistent(), name, "links of nodes are broken");
+
+  Check(deque.Size() == model.size(), name, "Size() does not match the reference model");
+  Check(deque.IsEmpty() == model.empty(), name, "IsEmpty() does not match the reference model");
+
+  if (model.empty())
+    return;
+
+  Check(deque.PeekHead() == model.front() && deque.PeekTail() == model.back(), name, "head or tail element is wrong");
+
+  auto forward = model.begin();
+
+  for (uint64_t value : deque) {
+    Check(forward != model.end() && value == *forward, name, "forward walk does not match the reference model");
+    ++forward;
+  }
+
+  Check(forward == model.end(), name, "forward walk is shorter than Size()");
+
+  auto backward = model.rbegin();
+
+  for (auto it = deque.rbegin(); it != deque.rend(); ++it) {
+    Check(backward != model.rend() && *it == *backward, name, "backward walk does not match the reference model");
+    ++backward;
+  }
+
+  Check(backward == model.rend(), name, "backward walk is shorter than Size()");
+}
+
+/**
+ * Run workload on deque in one thread checking it against a reference model
+ * @tparam container type of deque
+ * @param[in] name name of deque
+ * @param[in] deque deque to run workload on
+ * @param[in] config harness options
+ * @exception exception invariant is broken
+ */
+template <typename container>
+static void StressSequential(std::string_view name, container& deque, stress_config_t const& config) {
+  if (!config.only.empty() && name.find(config.only) == std::string_view::npos)
+    return;
+
+  op_stream_t stream(config.workload, config.seed);
+  op_latency_t latency;
+  std::deque<uint64_t> model;
+  uint64_t next = 0;
+  auto start = clock_type::now();
+
+  for (size_t i = 1; i <= config.ops; i++) {
+    op_t op = stream.Next();
+    bool front = op == op_t::pushFront || op == op_t::popFront;
+
+    if (op == op_t::pushBack || op == op_t::pushFront) {
+      auto opStart = clock_type::now();
+
+      Push(deque, front, next);
+      latency.ops[(size_t)op].Record(Elapsed(opStart));
+
+      if (front)
+        model.push_front(next++);
+      else
+        model.push_back(next++);
+    }
+    else {
+      auto opStart = clock_type::now();
+      std::optional<uint64_t> value = Pop(deque, front);
+
+      latency.ops[(size_t)op].Record(Elapsed(opStart));
+
+      if (model.empty()) {
+        Check(!value, name, "pop from empty deque returned an element");
+        latency.emptyPops++;
+      }
+      else {
+        Check(value && *value == (front ? model.front() : model.back()), name, "popped element does not match the reference model");
+
+        if (front)
+          model.pop_front();
+        else
+          model.pop_back();
+      }
+    }
+
+    if (i % config.checkEvery == 0)
+      CheckInvariants(name, deque, model);
+  }
+
+  uint64_t ns = Elapsed(start);
+
+  CheckInvariants(name, deque, model);
+  deque.Clear();
+  model.clear();
+  CheckInvariants(name, deque, model);
+  Report(name, latency, ns);
+}
+
+/**
+ * Run workload on thread-safe deque in several threads
+ *
+ * Elements are tagged with the producer thread and its sequence number; with FIFO workloads on ordered deques
+ * every consumer must see elements of every producer in increasing order. After the run Size() must equal pushed minus popped
+ * elements and draining the deque must give exactly that many elements
+ * @tparam container type of deque
+ * @param[in] name name of deque
+ * @param[in] deque deque to run workload on
+ * @param[in] config harness options
+ * @param[in] ordered true if the deque keeps the order of elements of one producer
+ * @exception exception invariant is broken
+ */
+template <typename container>
+static void StressConcurrent(std::string_view name, container& deque, stress_config_t const& config, bool ordered = true) {
+  if (!config.only.empty() && name.find(config.only) == std::string_view::npos)
+    return;
+
+  constexpr unsigned seqBits = 40;
+  unsigned threads = std::max(1u, config.threads);
+  bool fifo = ordered && config.workload.IsFifo();
+  std::vector<op_latency_t> latency(threads);
+  std::vector<uint64_t> pushed(threads, 0);
+  std::vector<uint64_t> popped(threads, 0);
+  std::vector<std::string> errors(threads);
+  std::vector<std::thread> workers;
+  std::atomic<unsigned> ready = 0;
+
+  for (unsigned t = 0; t < threads; t++)
+    workers.emplace_back([&, t]() {
+      op_stream_t stream(config.workload, config.seed + t);
+      std::vector<uint64_t> lastSeen(threads, 0);   // sequence number + 1 of the last element seen from every producer
+      uint64_t next = 0;
+
+      ready.fetch_add(1);
+      while (ready.load() < threads)
+        std::this_thread::yield();
+
+      try {
+        for (size_t i = 0; i < config.ops / threads; i++) {
+          op_t op = stream.Next();
+          bool front = op == op_t::pushFront || op == op_t::popFront;
+          auto opStart = clock_type::now();
+
+          if (op == op_t::pushBack || op == op_t::pushFront) {
+            Push(deque, front, (uint64_t(t) << seqBits) | next++);
+            latency[t].ops[(size_t)op].Record(Elapsed(opStart));
+            pushed[t]++;
+            continue;
+          }
+
+          std::optional<uint64_t> value = Pop(deque, front);
+
+          latency[t].ops[(size_t)op].Record(Elapsed(opStart));
+
+          if (!value) {
+            latency[t].emptyPops++;
+            continue;
+          }
+
+          uint64_t producer = *value >> seqBits;
+          uint64_t seq = *value & ((uint64_t(1) << seqBits) - 1);
+
+          Check(producer < threads, name, "popped element was never pushed");
+
+          if (fifo) {
+            Check(seq + 1 > lastSeen[producer], name, "elements of one producer are popped out of order");
+            lastSeen[producer] = seq + 1;
+          }
+
+          popped[t]++;
+        }
+      }
+      catch (std::exception const& e) {
+        errors[t] = e.what();
+      }
+    });
+
+  auto start = clock_type::now();
+
+  for (auto& w : workers)
+    w.join();
+
+  uint64_t ns = Elapsed(start);
+
+  for (auto& error : errors)
+    if (!error.empty())
+      throw exception(error.c_str());
+
+  uint64_t left = 0;
+  op_latency_t total;
+
+  for (unsigned t = 0; t < threads; t++) {
+    left += pushed[t] - popped[t];
+    total.Merge(latency[t]);
+  }
+
+  Check(deque.Size() == left, name, "Size() does not match pushed minus popped elements");
+
+  uint64_t drained = 0;
+
+  while (Pop(deque, true))
+    drained++;
+
+  Check(drained == left && deque.IsEmpty(), name, "draining gave a wrong number of elements");
+  Report(name, total, ns);
+}
+
+/**
+ * Print usage
+ */
+static void Usage() {
+  std::cout << "usage: deque_stress [options]\n"
+    << "  --ops=N          operations per deque (default 1000000)\n"
+    << "  --threads=N      threads for concurrent deques (default 4)\n"
+    << "  --mix=A/B/C/D    weights of PushBack/PushFront/PopFront/PopBack (default 70/0/30/0)\n"
+    << "  --burst=N        length of bursts of equal operations, 0 to disable (default 256)\n"
+    << "  --burst-period=N mean number of operations between bursts (default 1024)\n"
+    << "  --check=N        operations between invariant checks of sequential deques (default 4096)\n"
+    << "  --seed=N         seed of operation streams (default 1)\n"
+    << "  --only=NAME      run only deques with names containing NAME\n";
+}
+
+/**
+ * Parse command line
+ * @param[in] argc number of arguments
+ * @param[in] argv arguments
+ * @param[out] config harness options
+ * @return true if all arguments are valid, false otherwise
+ */
+static bool ParseArgs(int argc, char** argv, stress_config_t& config) {
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    size_t eq = arg.find('=');
+
+    if (eq == std::string_view::npos)
+      return false;
+
+    std::string_view key = arg.substr(0, eq);
+    std::string value(arg.substr(eq + 1));
+
+    try {
+      if (key == "--only")
+        config.only = value;
+      else if (key == "--mix") {
+        size_t pos = 0;
+
+        for (size_t op = 0; op < opCount; op++) {
+          size_t used = 0;
+
+          config.workload.weights[op] = (unsigned)std::stoul(value.substr(pos), &used);
+          pos += used + 1;
+
+          if (op + 1 < opCount && (pos > value.size() || value[pos - 1] != '/'))
+            return false;
+        }
+
+        if (pos <= value.size())
+          return false;
+      }
+      else {
+        uint64_t number = std::stoull(value);
+
+        if (key == "--ops")
+          config.ops = number;
+        else if (key == "--threads")
+          config.threads = (unsigned)number;
+        else if (key == "--burst")
+          config.workload.burstLength = number;
+        else if (key == "--burst-period" && number > 0)
+          config.workload.burstPeriod = number;
+        else if (key == "--check" && number > 0)
+          config.checkEvery = number;
+        else if (key == "--seed")
+          config.seed = number;
+        else
+          return false;
+      }
+    }
+    catch (std::exception const&) {
+      return false;
+    }
+  }
+
+  unsigned weightSum = 0;
+
+  for (unsigned weight : config.workload.weights)
+    weightSum += weight;
+
+  return weightSum > 0;
+}
+
+/**
+ * Stress harness entry point
+ * @return 0 if all invariants hold, 1 if one is broken, 2 if arguments are invalid
+ */
+int main(int argc, char** argv) {
+  stress_config_t config;
+
+  if (!ParseArgs(argc, argv, config)) {
+    Usage();
+    return 2;
+  }
+
+  workload_t const& w = config.workload;
+
+  std::cout << "mix " << w.weights[0] << '/' << w.weights[1] << '/' << w.weights[2] << '/' << w.weights[3]
+    << " (PushBack/PushFront/PopFront/PopBack), bursts of " << w.burstLength << " every ~" << w.burstPeriod << " ops, "
+    << config.ops << " ops per deque, " << config.threads << " threads, clock overhead " << ClockOverhead()
+    << " ns (included in latencies)\n\n";
+
+  try {
+    deque_t<uint64_t> simple;
+    deque_t<uint64_t, pool_allocator_t> pool;
+    deque_t<uint64_t, arena_allocator_t> arena;
+    deque_t<uint64_t> reserved;
+
+    reserved.Reserve(0, 4096);
+    StressSequential("deque_t", simple, config);
+    StressSequential("deque_t (Reserve)", reserved, config);
+    StressSequential("deque_t<pool_allocator_t>", pool, config);
+    StressSequential("deque_t<arena_allocator_t>", arena, config);
+
+    concurrent_deque_t<uint64_t> concurrent;
+    concurrent_deque_t<uint64_t, pool_allocator_t> concurrentPool;
+    concurrent_deque_t<uint64_t, magazine_allocator_t> concurrentMagazine;
+    sharded_deque_t<uint64_t> sharded;
+
+    StressConcurrent("concurrent_deque_t", concurrent, config);
+    StressConcurrent("concurrent_deque_t<pool_allocator_t>", concurrentPool, config);
+    StressConcurrent("concurrent_deque_t<magazine_allocator_t>", concurrentMagazine, config);
+
+    // a thread moving to other NUMA node pushes to other shard, so the order of its elements is not kept
+    StressConcurrent("sharded_deque_t", sharded, config, false);
+
+    if (config.workload.IsFifo()) {
+      async_deque_t<uint64_t> async;
+
+      StressConcurrent("async_deque_t", async, config);
+    }
+  }
+  catch (std::exception const& e) {
+    std::cout << "invariant broken: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << "all invariants hold" << std::endl;
+
+  return 0;
+}
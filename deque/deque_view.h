@@ -0,0 +1,255 @@
+#pragma once
+
+#include <exception>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include "snapshot.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using std::exception;
+
+/**
+ * @brief Read-only view of deque snapshot file
+ *
+ * The file written by Serialize is mapped into memory and elements are read straight from the mapping,
+ * so opening takes constant time regardless of the number of elements
+ * @tparam elemType type of stored elements (trivially copyable, alignment up to the snapshot header size)
+ * @see snapshot_header_t
+ */
+template <typename elemType>
+class deque_view_t {
+private:
+  static_assert(std::is_trivially_copyable_v<elemType>, "Snapshot elements must be trivially copyable");
+  static_assert(alignof(elemType) <= sizeof(snapshot_header_t), "Snapshot payload is not aligned for elements");
+
+  void const* mapping;      ///< start of the mapped file (nullptr if nothing is mapped)
+  size_t mappingSize;       ///< size of the mapped file in bytes
+  elemType const* data;     ///< pointer to the first element
+  size_t size;              ///< number of elements
+
+  /**
+   * Unmap the file
+   */
+  void Unmap() noexcept {
+    if (mapping) {
+#ifdef _WIN32
+      UnmapViewOfFile(mapping);
+#else
+      munmap((void*)mapping, mappingSize);
+#endif
+    }
+
+    mapping = nullptr;
+    mappingSize = 0;
+    data = nullptr;
+    size = 0;
+  }
+public:
+  using iterator = elemType const*;         ///< iterator type (elements are contiguous)
+  using const_iterator = elemType const*;   ///< const iterator type
+
+  /**
+   * Map snapshot file
+   * @param[in] path path to file written by Serialize
+   * @exception "Failed to open snapshot" if the file cannot be opened or mapped
+   * @exception "Snapshot is truncated" if the file is shorter than its header says
+   * @see CheckSnapshotHeader
+   */
+  explicit deque_view_t(char const* path) : mapping(nullptr), mappingSize(0), data(nullptr), size(0) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER fileSize;
+
+    if (file == INVALID_HANDLE_VALUE)
+      throw exception("Failed to open snapshot");
+
+    if (!GetFileSizeEx(file, &fileSize) || (uint64_t)fileSize.QuadPart < sizeof(snapshot_header_t)) {
+      CloseHandle(file);
+      throw exception("Snapshot is truncated");
+    }
+
+    HANDLE map = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    CloseHandle(file);
+
+    if (map == nullptr)
+      throw exception("Failed to open snapshot");
+
+    mapping = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(map);
+
+    if (mapping == nullptr)
+      throw exception("Failed to open snapshot");
+
+    mappingSize = (size_t)fileSize.QuadPart;
+#else
+    int file = open(path, O_RDONLY);
+    struct stat info;
+
+    if (file < 0)
+      throw exception("Failed to open snapshot");
+
+    if (fstat(file, &info) != 0 || (uint64_t)info.st_size < sizeof(snapshot_header_t)) {
+      close(file);
+      throw exception("Snapshot is truncated");
+    }
+
+    void* map = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, file, 0);
+
+    close(file);
+
+    if (map == MAP_FAILED)
+      throw exception("Failed to open snapshot");
+
+    mapping = map;
+    mappingSize = (size_t)info.st_size;
+#endif
+
+    try {
+      snapshot_header_t const& header = *(snapshot_header_t const*)mapping;
+
+      CheckSnapshotHeader(header, sizeof(elemType));
+
+      if (header.count > (mappingSize - sizeof(snapshot_header_t)) / sizeof(elemType))
+        throw exception("Snapshot is truncated");
+
+      data = (elemType const*)((char const*)mapping + sizeof(snapshot_header_t));
+      size = (size_t)header.count;
+    }
+    catch (...) {
+      Unmap();
+      throw;
+    }
+  }
+
+  deque_view_t(deque_view_t const&) = delete;
+  deque_view_t& operator=(deque_view_t const&) = delete;
+
+  /**
+   * Move constructor
+   * @param[in] view rvalue reference on view to move
+   */
+  deque_view_t(deque_view_t&& view) noexcept : mapping(view.mapping), mappingSize(view.mappingSize), data(view.data), size(view.size) {
+    view.mapping = nullptr;
+    view.mappingSize = 0;
+    view.data = nullptr;
+    view.size = 0;
+  }
+
+  /**
+   * Move operator=
+   * @param[in] view rvalue reference on view to move
+   */
+  void operator=(deque_view_t&& view) noexcept {
+    if (this == &view)
+      return;
+
+    Unmap();
+    mapping = view.mapping;
+    mappingSize = view.mappingSize;
+    data = view.data;
+    size = view.size;
+
+    view.mapping = nullptr;
+    view.mappingSize = 0;
+    view.data = nullptr;
+    view.size = 0;
+  }
+
+  /**
+   * Check is view empty method
+   * @return true if there are no elements, false otherwise
+   */
+  bool IsEmpty() const noexcept {
+    return size == 0;
+  }
+
+  /**
+   * Get view size method
+   * @return number of elements
+   */
+  size_t Size() const noexcept {
+    return size;
+  }
+
+  /**
+   * Method to see what first element is
+   * @returns const reference on element
+   * @exception "Deque is empty" if there are no elements
+   */
+  elemType const& PeekHead() const {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    return data[0];
+  }
+
+  /**
+   * Method to see what last element is
+   * @returns const reference on element
+   * @exception "Deque is empty" if there are no elements
+   */
+  elemType const& PeekTail() const {
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    return data[size - 1];
+  }
+
+  /**
+   * Operator [] (index is not checked)
+   * @param[in] index index of element
+   * @return const reference on element
+   */
+  elemType const& operator[](size_t index) const noexcept {
+    return data[index];
+  }
+
+  /**
+   * Get element by index method
+   * @param[in] index index of element
+   * @return const reference on element
+   * @exception "Index is out of range" if index is not less than size
+   */
+  elemType const& At(size_t index) const {
+    if (index >= size)
+      throw exception("Index is out of range");
+
+    return data[index];
+  }
+
+  /**
+   * Method begin for iterator
+   * @return iterator that corresponds first element
+   */
+  const_iterator begin() const noexcept {
+    return data;
+  }
+
+  /**
+   * Method end for iterator
+   * @return iterator that corresponds element after last
+   */
+  const_iterator end() const noexcept {
+    return data + size;
+  }
+
+  /**
+   * View destructor (unmaps the file)
+   */
+  ~deque_view_t() {
+    Unmap();
+  }
+};
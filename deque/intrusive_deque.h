@@ -0,0 +1,421 @@
+#pragma once
+
+#include <exception>
+#include <iterator>
+#include <cstddef>
+#include "iterator_policy.h"
+
+using std::exception;
+
+/**
+ * @brief Intrusive deque hook
+ *
+ * Links embedded into the element type, an element may be in one deque per hook member at a time
+ * @tparam elemType type of elements containing the hook
+ */
+template <typename elemType>
+struct intrusive_hook_t {
+  elemType* prev = nullptr;   ///< pointer to previous element (nullptr if the element is the first one)
+  elemType* next = nullptr;   ///< pointer to next element (nullptr if the element is the last one)
+};
+
+/**
+ * @brief Intrusive deque class
+ *
+ * Doubly-linked deque over elements owned by the caller: links live in the 'hook' member of the element,
+ * so push and pop only relink pointers and never allocate, copy or destroy elements
+ * @tparam elemType type of stored elements
+ * @tparam hook pointer to the hook member of 'elemType'
+ * @warning an element must stay alive and must not be put into another deque by the same hook while it is linked
+ */
+template <typename elemType, intrusive_hook_t<elemType> elemType::* hook>
+class intrusive_deque_t {
+private:
+  elemType* head;     ///< pointer to the first element (nullptr if the deque is empty)
+  elemType* tail;     ///< pointer to the last element (nullptr if the deque is empty)
+  size_t size;        ///< number of elements in the deque
+
+  /**
+   * Get links of element
+   * @param[in] elem pointer to element
+   * @return reference on element hook
+   */
+  static intrusive_hook_t<elemType>& Links(elemType* elem) noexcept {
+    return elem->*hook;
+  }
+public:
+  /**
+   * @brief Intrusive deque iterator
+   *
+   * Allows to iterate in direct order in deque
+   */
+  class iterator {
+  private:
+    elemType* cur;    ///< Pointer to the element to which the iterator corresponds (nullptr for end)
+    elemType* last;   ///< Pointer to the last element of deque (to step back from end)
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;   ///< iterator category for standard algorithms
+    using value_type = elemType;                                 ///< type of elements
+    using difference_type = ptrdiff_t;                           ///< type of distance between iterators
+    using pointer = elemType*;                                   ///< pointer to element
+    using reference = elemType&;                                 ///< reference on element
+
+    /**
+     * Default constructor for iterator
+     */
+    iterator() : cur(nullptr), last(nullptr) {}
+
+    /**
+     * Constructor from element and last element of deque
+     * @param[in] cur pointer to the element we want to build iterator from (nullptr for end)
+     * @param[in] last pointer to the last element of deque
+     */
+    iterator(elemType* cur, elemType* last) : cur(cur), last(last) {}
+
+    /**
+     * Prefix ++ operator
+     * @return reference to next iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (cur == nullptr)
+          throw exception("Try to use end iterator");
+
+      cur = Links(cur).next;
+
+      return *this;
+    }
+
+    /**
+     * Postfix ++ operator
+     * @return reference to current iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    iterator operator++(int) noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      ++*this;
+
+      return tmp;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to previous iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    iterator& operator--() noexcept(!checkedIterators) {
+      elemType* prev = cur ? Links(cur).prev : last;
+
+      if constexpr (checkedIterators)
+        if (prev == nullptr)
+          throw exception("Iterator is out of range");
+
+      cur = prev;
+
+      return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    iterator operator--(int) noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      --*this;
+
+      return tmp;
+    }
+
+    /**
+     * Comparison operator ==
+     * @param[in] iter iterator we want to compare with
+     * @return true if equals, false otherwise
+     */
+    bool operator==(iterator const& iter) const noexcept {
+      return cur == iter.cur;
+    }
+
+    /**
+     * Comparison operator !=
+     * @param[in] iter iterator we want to compare with
+     * @return false if equals, true otherwise
+     */
+    bool operator!=(iterator const& iter) const noexcept {
+      return !(*this == iter);
+    }
+
+    /**
+     * Operator *
+     * @return reference on element to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType& operator*() const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (cur == nullptr)
+          throw exception("Try to use end iterator");
+
+      return *cur;
+    }
+
+    /**
+     * Operator ->
+     * @return pointer to element to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType* operator->() const noexcept(!checkedIterators) {
+      return &**this;
+    }
+  };
+
+  /**
+   * Method begin for iterator
+   * @return iterator that corresponds first element
+   */
+  iterator begin() const noexcept {
+    return iterator(head, tail);
+  }
+
+  /**
+   * Method end for iterator
+   * @return iterator that corresponds element after last
+   */
+  iterator end() const noexcept {
+    return iterator(nullptr, tail);
+  }
+
+  /**
+   * Default deque constructor
+   */
+  intrusive_deque_t() : head(nullptr), tail(nullptr), size(0) {}
+
+  intrusive_deque_t(intrusive_deque_t const&) = delete;
+  intrusive_deque_t& operator=(intrusive_deque_t const&) = delete;
+
+  /**
+   * Move constructor
+   * @param[in] deque rvalue reference on deque to move
+   */
+  intrusive_deque_t(intrusive_deque_t&& deque) noexcept : head(deque.head), tail(deque.tail), size(deque.size) {
+    deque.head = nullptr;
+    deque.tail = nullptr;
+    deque.size = 0;
+  }
+
+  /**
+   * Move operator= (elements of current deque are forgotten, their hooks keep old links)
+   * @param[in] deque rvalue reference on deque to move
+   */
+  void operator=(intrusive_deque_t&& deque) noexcept {
+    if (this == &deque)
+      return;
+
+    head = deque.head;
+    tail = deque.tail;
+    size = deque.size;
+
+    deque.head = nullptr;
+    deque.tail = nullptr;
+    deque.size = 0;
+  }
+
+  /**
+   * Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  bool IsEmpty() const noexcept {
+    return head == nullptr;
+  }
+
+  /**
+   * Get deque size method
+   * @return number of elements in the deque
+   */
+  size_t Size() const noexcept {
+    return size;
+  }
+
+  /**
+   * Method to get first element
+   * @returns reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& GetFront() const {
+    if (head == nullptr)
+      throw exception("Deque is empty");
+
+    return *head;
+  }
+
+  /**
+   * Method to get last element
+   * @returns reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& GetBack() const {
+    if (tail == nullptr)
+      throw exception("Deque is empty");
+
+    return *tail;
+  }
+
+  /**
+   * Method to see what first element is without throwing on empty deque
+   * @returns pointer to first element or nullptr if deque is empty
+   */
+  elemType* TryPeekHead() const noexcept {
+    return head;
+  }
+
+  /**
+   * Method to see what last element is without throwing on empty deque
+   * @returns pointer to last element or nullptr if deque is empty
+   */
+  elemType* TryPeekTail() const noexcept {
+    return tail;
+  }
+
+  /**
+   * Method to link element at begin of deque
+   * @param[in] elem reference on element that is not linked by this hook
+   */
+  void PushFront(elemType& elem) noexcept {
+    Links(&elem).prev = nullptr;
+    Links(&elem).next = head;
+
+    if (head)
+      Links(head).prev = &elem;
+    else
+      tail = &elem;
+
+    head = &elem;
+    size++;
+  }
+
+  /**
+   * Method to link element at end of deque
+   * @param[in] elem reference on element that is not linked by this hook
+   */
+  void PushBack(elemType& elem) noexcept {
+    Links(&elem).prev = tail;
+    Links(&elem).next = nullptr;
+
+    if (tail)
+      Links(tail).next = &elem;
+    else
+      head = &elem;
+
+    tail = &elem;
+    size++;
+  }
+
+  /**
+   * Method to unlink element from any position of deque
+   * @param[in] elem reference on element linked into this deque
+   */
+  void Remove(elemType& elem) noexcept {
+    intrusive_hook_t<elemType>& links = Links(&elem);
+
+    if (links.prev)
+      Links(links.prev).next = links.next;
+    else
+      head = links.next;
+
+    if (links.next)
+      Links(links.next).prev = links.prev;
+    else
+      tail = links.prev;
+
+    links.prev = nullptr;
+    links.next = nullptr;
+    size--;
+  }
+
+  /**
+   * Method to unlink first element without throwing on empty deque
+   * @returns pointer to unlinked element or nullptr if deque is empty
+   */
+  elemType* TryPopFront() noexcept {
+    elemType* elem = head;
+
+    if (elem)
+      Remove(*elem);
+
+    return elem;
+  }
+
+  /**
+   * Method to unlink last element without throwing on empty deque
+   * @returns pointer to unlinked element or nullptr if deque is empty
+   */
+  elemType* TryPopBack() noexcept {
+    elemType* elem = tail;
+
+    if (elem)
+      Remove(*elem);
+
+    return elem;
+  }
+
+  /**
+   * Method to unlink first element
+   * @returns reference on unlinked element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& PopFront() {
+    if (head == nullptr)
+      throw exception("Deque is empty");
+
+    return *TryPopFront();
+  }
+
+  /**
+   * Method to unlink last element
+   * @returns reference on unlinked element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& PopBack() {
+    if (tail == nullptr)
+      throw exception("Deque is empty");
+
+    return *TryPopBack();
+  }
+
+  /**
+   * Method for moving all elements of another deque to the end of the current one (constant time)
+   * @param[in] deque rvalue reference on other deque
+   * @returns refernece on current deque
+   */
+  intrusive_deque_t& AddOtherDeque(intrusive_deque_t&& deque) noexcept {
+    if (this == &deque || deque.head == nullptr)
+      return *this;
+
+    if (tail) {
+      Links(tail).next = deque.head;
+      Links(deque.head).prev = tail;
+    }
+    else
+      head = deque.head;
+
+    tail = deque.tail;
+    size += deque.size;
+
+    deque.head = nullptr;
+    deque.tail = nullptr;
+    deque.size = 0;
+
+    return *this;
+  }
+
+  /**
+   * Clear deque (elements are only forgotten, their hooks keep old links)
+   */
+  void Clear(void) noexcept {
+    head = nullptr;
+    tail = nullptr;
+    size = 0;
+  }
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * Iterator checking policy
+ *
+ * If DEQUE_CHECKED_ITERATORS is not 0, deque iterators check every step and dereference and throw
+ * "Try to use end iterator" or "Iterator is out of range"; otherwise the checks are compiled out and
+ * iterator operations are noexcept. Checked by default unless NDEBUG is defined.
+ * The value must be the same in all translation units of a program
+ */
+#ifndef DEQUE_CHECKED_ITERATORS
+#ifdef NDEBUG
+#define DEQUE_CHECKED_ITERATORS 0
+#else
+#define DEQUE_CHECKED_ITERATORS 1
+#endif
+#endif
+
+/**
+ * True if deque iterators check their use and throw on errors
+ */
+constexpr bool checkedIterators = DEQUE_CHECKED_ITERATORS != 0;
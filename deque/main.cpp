@@ -1,4 +1,155 @@
-﻿#include "deque.h"
+﻿#include <string>
+#include <vector>
+#include <iterator>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <fstream>
+#include <filesystem>
+#include <coroutine>
+#include <exception>
+#include "deque.h"
+#include "block_deque.h"
+#include "small_deque.h"
+#include "concurrent_deque.h"
+#include "work_stealing_deque.h"
+#include "sharded_deque.h"
+#include "async_deque.h"
+#include "ring_deque.h"
+#include "intrusive_deque.h"
+#include "deque_view.h"
+
+/**
+ * Simulate task work
+ * @param[in] task task to run
+ * @return task result
+ */
+static long long RunTask(int task) {
+  long long sum = 0;
+
+  for (int i = 0; i < 256; i++)
+    sum += (task ^ i) % 7;
+
+  return sum;
+}
+
+/**
+ * Run tasks on thread pool with per-worker work-stealing deques
+ * @param[in] threads number of workers
+ * @param[in] tasks number of tasks
+ * @return elapsed time in milliseconds
+ */
+static double RunWorkStealingPool(unsigned threads, int tasks) {
+  std::vector<std::unique_ptr<work_stealing_deque_t<int>>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<int> done = 0;
+  std::atomic<long long> result = 0;
+
+  for (unsigned t = 0; t < threads; t++)
+    queues.emplace_back(std::make_unique<work_stealing_deque_t<int>>());
+  for (int i = 0; i < tasks; i++)
+    queues[i % threads]->PushBack(i);
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < threads; t++)
+    workers.emplace_back([&, t]() {
+      long long sum = 0;
+      unsigned victim = t;
+      while (done.load(std::memory_order_relaxed) < tasks) {
+        std::optional<int> task = queues[t]->TryPopBack();
+        if (!task)
+          task = queues[victim = (victim + 1) % threads]->Steal();
+        if (task) {
+          sum += RunTask(*task);
+          done.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      result += sum;
+    });
+  for (auto& w : workers)
+    w.join();
+
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Run tasks on thread pool with one mutex-wrapped deque
+ * @param[in] threads number of workers
+ * @param[in] tasks number of tasks
+ * @return elapsed time in milliseconds
+ */
+static double RunMutexPool(unsigned threads, int tasks) {
+  deque_t<int> queue;
+  std::mutex mutex;
+  std::vector<std::thread> workers;
+  std::atomic<long long> result = 0;
+
+  for (int i = 0; i < tasks; i++)
+    queue.PushBack(i);
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned t = 0; t < threads; t++)
+    workers.emplace_back([&]() {
+      long long sum = 0;
+      for (;;) {
+        int task;
+        {
+          std::lock_guard<std::mutex> guard(mutex);
+          if (queue.IsEmpty())
+            break;
+          task = queue.GetBack();
+          queue.PopBack();
+        }
+        sum += RunTask(task);
+      }
+      result += sum;
+    });
+  for (auto& w : workers)
+    w.join();
+
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Detached coroutine
+ *
+ * Coroutine that starts at once and frees its frame when it finishes
+ */
+struct detached_t {
+  struct promise_type {
+    detached_t get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+/**
+ * Sum elements of asynchronous queue until it is closed
+ * @param[in] queue queue to consume
+ * @param[out] sum sum of consumed elements
+ */
+static detached_t ConsumeAsync(async_deque_t<int>& queue, long long& sum) {
+  while (std::optional<int> value = co_await queue.PopFront())
+    sum += *value;
+}
+
+/**
+ * Push elements to asynchronous queue and close it
+ * @param[in] queue queue to fill
+ * @param[in] count number of elements
+ */
+static detached_t ProduceAsync(async_deque_t<int>& queue, int count) {
+  for (int i = 1; i <= count; i++)
+    co_await queue.PushBack(i);
+  queue.Close();
+}
 
 int main() {
   // default constructor
@@ -71,10 +222,311 @@ int main() {
   // AddOtherDeque with copy
   std::cout << "AddOtherDeque with copy {1-5} + d2: " << deque_t<int>({ 1, 2, 3, 4, 5 }).AddOtherDeque(d2) << std::endl;
 
+  // EmplaceFront and EmplaceBack
+  deque_t<std::string> s1;
+  s1.EmplaceBack(3, 'b');
+  s1.EmplaceFront("aa");
+  std::cout << "EmplaceFront \"aa\" and EmplaceBack (3, 'b') into s1: s1 = " << s1 << std::endl;
+
+  // PushBackRange and PushFrontRange
+  std::vector<int> batch = { 7, 8, 9 };
+  deque_t<int> r2;
+  r2.PushBackRange(batch).PushFrontRange(batch.begin(), batch.begin() + 2);
+  std::cout << "PushBackRange {7, 8, 9} and PushFrontRange {7, 8} into r2: r2 = " << r2 << std::endl;
+
+  // PopFrontN and DrainTo
+  std::vector<int> out;
+  r2.PopFrontN(2, std::back_inserter(out));
+  std::cout << "PopFrontN 2 from r2: r2 = " << r2 << "popped: ";
+  r2.DrainTo(std::back_inserter(out));
+  for (auto& o : out)
+    std::cout << o << " ";
+  std::cout << std::endl << "r2 IsEmpty after DrainTo: " << r2.IsEmpty() << std::endl << std::endl;
+
+  // TryPopFront, TryPopBack and TryPeekHead
+  deque_t<std::string> q1({ "first", "last" });
+  std::optional<std::string> taken = q1.TryPopFront();
+  std::cout << "TryPopFront from q1: " << *taken << ", TryPeekHead: " << *q1.TryPeekHead();
+  q1.TryPopBack();
+  std::cout << ", TryPopBack on empty q1 has value: " << q1.TryPopBack().has_value()
+    << ", TryPeekHead is nullptr: " << (q1.TryPeekHead() == nullptr) << std::endl << std::endl;
+
+  // SplitAt, Splice and SpliceFront
+  deque_t<int> whole({ 1, 2, 3, 4, 5, 6 });
+  auto middle = whole.begin();
+  for (int i = 0; i < 3; i++)
+    ++middle;
+  deque_t<int> half = whole.SplitAt(middle);
+  std::cout << "SplitAt 3 of {1-6}: whole = " << whole << "half = " << half;
+  whole.Splice(whole.begin(), half, ++half.begin(), half.end());
+  std::cout << "Splice {5, 6} before begin of whole: whole = " << whole;
+  whole.SpliceFront(std::move(half));
+  std::cout << "SpliceFront of rest: whole = " << whole << "half IsEmpty: " << half.IsEmpty() << std::endl;
+  std::cout << "WriteTo with \", \" separator: ";
+  whole.WriteTo(std::cout, ", ") << std::endl << std::endl;
+
+  // MergeSorted and InsertSorted
+  deque_t<int> early({ 1, 4, 6, 9 });
+  early.MergeSorted(deque_t<int>({ 2, 3, 7, 10 }));
+  std::cout << "MergeSorted of {1, 4, 6, 9} and {2, 3, 7, 10}: " << early;
+  early.InsertSorted(5);
+  early.InsertSorted(0);
+  early.InsertSorted(11);
+  std::cout << "InsertSorted of 5, 0 and 11: " << early;
+  deque_t<int> descending({ 9, 5, 1 });
+  descending.InsertSorted(7, std::greater<>());
+  std::cout << "InsertSorted of 7 by std::greater: " << descending << std::endl;
+
   // Clear and IsEmpty
   std::cout << "d2 IsEmpty: " << d2.IsEmpty() << std::endl;
   d2.Clear();
-  std::cout << "d2 IsEmpty after Clear: " << d2.IsEmpty() << std::endl;
+  std::cout << "d2 IsEmpty after Clear: " << d2.IsEmpty() << std::endl << std::endl;
+
+  // block deque
+  block_deque_t<int> b1({ 1, 2, 3, 4, 5 });
+  for (int i = 0; i < 1000; i++) {
+    b1.PushFront(i);
+    b1.PushBack(i);
+  }
+  for (int i = 0; i < 1000; i++) {
+    b1.PopFront();
+    b1.PopBack();
+  }
+  std::cout << "block deque after 1000 PushFront/PushBack/PopFront/PopBack: b1 = " << b1 << std::endl;
+
+  // random access
+  block_deque_t<int> b2({ 5, 3, 9, 1, 7 });
+  std::sort(b2.begin(), b2.end());
+  std::cout << "b2 after std::sort: " << b2;
+  std::cout << "b2[2] = " << b2[2] << ", b2.At(4) = " << b2.At(4) << ", position of 7: "
+    << std::lower_bound(b2.begin(), b2.end(), 7) - b2.begin() << std::endl << std::endl;
+
+  // small deque with inline storage
+  small_deque_t<std::string, 4> small({ "a", "b" });
+  small.PushFront("front");
+  small.PushBack("back");
+  std::cout << "small deque: " << small << "no allocations: " << small.IsInline();
+  small.PushBack("overflow");
+  std::cout << ", after overflow: " << small.IsInline();
+  small.PopBack();
+  small.ShrinkToFit();
+  std::cout << ", after ShrinkToFit: " << small.IsInline() << ", size = " << small.Size() << std::endl << std::endl;
+
+  // pool allocator
+  deque_t<int, pool_allocator_t> p1;
+  p1.GetAllocator().Reserve(100, p1.NodeSize());
+  for (int i = 0; i < 100; i++)
+    p1.PushBack(i);
+  for (int i = 0; i < 95; i++)
+    p1.PopFront();
+  std::cout << "pool deque after 100 PushBack and 95 PopFront: p1 = ";
+  for (auto& p : p1)
+    std::cout << p << " ";
+  std::cout << std::endl << "free slots in pool: " << p1.GetAllocator().FreeSlots() << std::endl;
+
+  // Reserve, Capacity and ShrinkToFit
+  deque_t<int> linked;
+  block_deque_t<int> blocks;
+  linked.Reserve(100, 1000);
+  blocks.Reserve(100, 1000);
+  std::cout << "capacity after Reserve(100, 1000): linked " << linked.Capacity() << ", block " << blocks.Capacity();
+  for (int i = 0; i < 10; i++) {
+    linked.PushBack(i);
+    blocks.PushBack(i);
+  }
+  linked.ShrinkToFit();
+  blocks.ShrinkToFit();
+  std::cout << ", after 10 PushBack and ShrinkToFit: linked " << linked.Capacity() << ", block " << blocks.Capacity() << std::endl;
+
+  // runtime-polymorphic allocator
+  allocator_adapter_t<pool_allocator_t> pool;
+  polymorphic_allocator_t poolAllocator(&pool);
+  deque_t<int, polymorphic_allocator_t> r1(poolAllocator);
+  r1.PushBack(1);
+  r1.PushBack(2);
+  std::cout << "deque with polymorphic allocator: r1 = ";
+  for (auto& r : r1)
+    std::cout << r << " ";
+  std::cout << std::endl << "sizeof(deque_t<int>): " << sizeof(deque_t<int>) << ", sizeof(deque_t<int, polymorphic_allocator_t>): "
+    << sizeof(deque_t<int, polymorphic_allocator_t>) << std::endl;
+
+  // allocator latency statistics
+  allocator_adapter_t<simple_allocator_t> heap;
+  stats_allocator_t statsAllocator(heap);
+  {
+    polymorphic_allocator_t statsResource(&statsAllocator);
+    deque_t<int, polymorphic_allocator_t> s1(statsResource);
+    for (int i = 0; i < 1000; i++)
+      s1.PushBack(i);
+  }
+  latency_histogram_t allocLatency = statsAllocator.AllocLatency();
+  std::cout << "allocations through stats allocator: " << allocLatency.count << ", deallocations: " << statsAllocator.DeallocLatency().count << std::endl;
+  WritePrometheus(std::cout, allocLatency, "deque_alloc_latency_seconds");
+  if constexpr (dequeStats)
+    WritePrometheus(std::cout, deque_stats_t::Snapshot(), "deque");
+  std::cout << std::endl;
+
+  // arena allocator
+  arena_allocator_t arena;
+  for (int i = 0; i < 1000; i++) {
+    deque_t<int, arena_allocator_t> a1(arena);
+    for (int j = 0; j < 100; j++)
+      a1.PushBack(j);
+  }
+  std::cout << "arena capacity after 1000 temporary deques: " << arena.Capacity();
+  arena.Reset();
+  std::cout << ", after Reset: " << arena.Capacity() << std::endl;
+
+  // concurrent deque
+  concurrent_deque_t<int> c1;
+  std::atomic<long long> consumed = 0;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; t++)
+    workers.emplace_back([&c1, t]() {
+      for (int i = 1; i <= 10000; i++)
+        t % 2 ? c1.PushBack(i) : c1.PushFront(i);
+    });
+  for (int t = 0; t < 4; t++)
+    workers.emplace_back([&c1, &consumed, t]() {
+      for (int i = 0; i < 10000; i++) {
+        std::optional<int> value;
+        while (!(value = t % 2 ? c1.TryPopBack() : c1.TryPopFront()))
+          std::this_thread::yield();
+        consumed += *value;
+      }
+    });
+  for (auto& w : workers)
+    w.join();
+  std::cout << "concurrent deque: sum of consumed elements = " << consumed << ", size = " << c1.Size() << std::endl;
+
+  // magazine allocator: nodes pushed by one thread are freed by another
+  concurrent_deque_t<int, magazine_allocator_t> m1;
+  long long handedOver = 0;
+  std::thread handOver([&m1]() {
+    for (int i = 1; i <= 100000; i++)
+      m1.PushBack(i);
+  });
+  for (int i = 0; i < 100000; i++) {
+    std::optional<int> value;
+    while (!(value = m1.TryPopFront()))
+      std::this_thread::yield();
+    handedOver += *value;
+  }
+  handOver.join();
+  std::cout << "magazine allocator: sum of handed over elements = " << handedOver << ", size = " << m1.Size() << std::endl;
+
+  // NUMA-sharded deque
+  sharded_deque_t<int> sharded;
+  std::atomic<long long> drained = 0;
+  std::vector<std::thread> socketWorkers;
+  for (int t = 0; t < 4; t++)
+    socketWorkers.emplace_back([&sharded, &drained]() {
+      for (int i = 1; i <= 10000; i++)
+        sharded.PushBack(i);
+      while (std::optional<int> value = sharded.TryPopFront())
+        drained += *value;
+    });
+  for (auto& w : socketWorkers)
+    w.join();
+  std::cout << "sharded deque: " << NumaNodeCount() << " NUMA nodes, " << sharded.ShardCount() << " shards, sum of drained elements = "
+    << drained << ", size = " << sharded.Size() << std::endl;
+
+  // coroutine queue with backpressure
+  async_deque_t<int> channel(4);
+  long long asyncSum = 0;
+  ProduceAsync(channel, 100);
+  std::cout << "async deque: " << channel.Size() << " of " << channel.Capacity() << " buffered before consumer starts";
+  ConsumeAsync(channel, asyncSum);
+  std::cout << ", sum of consumed elements = " << asyncSum << ", closed = " << channel.IsClosed() << std::endl;
+
+  // bounded SPSC ring deque
+  ring_deque_t<int, 1024> ring;
+  long long ringSum = 0;
+  std::thread producer([&ring]() {
+    for (int i = 1; i <= 100000; i++)
+      while (!ring.TryPushBack(i))
+        std::this_thread::yield();
+  });
+  for (int i = 0; i < 100000; i++) {
+    std::optional<int> value;
+    while (!(value = ring.TryPopFront()))
+      std::this_thread::yield();
+    ringSum += *value;
+  }
+  producer.join();
+  std::cout << "ring deque: sum of consumed elements = " << ringSum << ", size = " << ring.Size() << std::endl;
+
+  // intrusive deque over caller-owned messages
+  struct message_t {
+    int id;
+    intrusive_hook_t<message_t> hook;
+  };
+  std::vector<message_t> messages(6);
+  intrusive_deque_t<message_t, &message_t::hook> inbox, urgent;
+  for (int i = 0; i < 6; i++) {
+    messages[i].id = i;
+    if (i % 3 == 0)
+      urgent.PushFront(messages[i]);
+    else
+      inbox.PushBack(messages[i]);
+  }
+  inbox.Remove(messages[4]);
+  urgent.AddOtherDeque(std::move(inbox));
+  std::cout << "intrusive deque:";
+  for (auto& m : urgent)
+    std::cout << " " << m.id;
+  std::cout << ", popped " << urgent.PopFront().id << ", size = " << urgent.Size() << std::endl;
+
+  // binary snapshot and memory-mapped view
+  std::string snapshotPath = (std::filesystem::temp_directory_path() / "deque_demo.snapshot").string();
+  block_deque_t<long long> saved;
+  for (long long i = 1; i <= 100000; i++)
+    saved.PushBack(i * i);
+  {
+    std::ofstream file(snapshotPath, std::ios::binary);
+    saved.Serialize(file);
+  }
+  {
+    std::ifstream file(snapshotPath, std::ios::binary);
+    deque_t<long long> restored;
+    restored.Deserialize(file);
+    deque_view_t<long long> view(snapshotPath.c_str());
+    std::cout << "snapshot of " << saved.Size() << " elements: restored size = " << restored.Size()
+      << ", view tail = " << view.PeekTail() << ", view[9] = " << view[9] << std::endl;
+  }
+  std::filesystem::remove(snapshotPath);
+
+  // parallel ForEach, Transform and Reduce
+  block_deque_t<double> values;
+  deque_t<double> linkedValues;
+  for (int i = 1; i <= 2000000; i++) {
+    values.PushBack(i);
+    linkedValues.PushBack(i);
+  }
+  values.Transform([](double v) { return v * 2; });
+  linkedValues.ForEach([](double& v) { v *= 2; });
+  for (unsigned threads = 1; threads <= 8; threads *= 2) {
+    auto start = std::chrono::steady_clock::now();
+    double blockSum = values.Reduce(0.0, [](double a, double b) { return a + b; }, threads);
+    auto middle = std::chrono::steady_clock::now();
+    double linkedSum = linkedValues.Reduce(0.0, [](double a, double b) { return a + b; }, threads);
+    auto stop = std::chrono::steady_clock::now();
+    std::cout << "Reduce of 2000000 doubles with " << threads << " threads: block deque " << blockSum << " in "
+      << std::chrono::duration<double, std::milli>(middle - start).count() << " ms, linked deque " << linkedSum << " in "
+      << std::chrono::duration<double, std::milli>(stop - middle).count() << " ms" << std::endl;
+  }
+
+  // vectorized bulk kernels
+  std::cout << "bulk kernels (" << (SimdLevel() == simd_level_t::avx2 ? "avx2" : "scalar") << "): Sum = " << values.Sum()
+    << ", Min = " << values.Min() << ", Max = " << values.Max() << ", Count(8) = " << values.Count(8)
+    << ", Find(8) = " << values.Find(8) << std::endl;
+  values.Fill(1);
+  std::cout << "Sum after Fill(1) = " << values.Sum() << std::endl;
+
+  // work-stealing thread pool against mutex-wrapped deque
+  for (unsigned threads = 1; threads <= 8; threads *= 2)
+    std::cout << "thread pool with " << threads << " workers, 200000 tasks: work-stealing " << RunWorkStealingPool(threads, 200000)
+      << " ms, mutex deque " << RunMutexPool(threads, 200000) << " ms" << std::endl;
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstddef>
+#include <exception>
+#include "allocator.h"
+
+#if defined(DEQUE_HAVE_LIBNUMA)
+#include <numa.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+using std::exception;
+
+/**
+ * NUMA support
+ *
+ * Nodes are queried and memory is bound through libnuma if DEQUE_HAVE_LIBNUMA is defined (set by CMake when the library is found)
+ * or through the system API on Windows; otherwise the machine is treated as a single node and malloc is used
+ */
+
+/**
+ * Check NUMA support method
+ * @return true if memory can be bound to nodes, false otherwise
+ */
+inline bool NumaAvailable() noexcept {
+#if defined(DEQUE_HAVE_LIBNUMA)
+  static bool const available = numa_available() >= 0;
+
+  return available;
+#elif defined(_WIN32)
+  ULONG highest;
+
+  return GetNumaHighestNodeNumber(&highest) != 0;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Get number of NUMA nodes method
+ * @return number of nodes (1 if NUMA is not supported)
+ */
+inline size_t NumaNodeCount() noexcept {
+#if defined(DEQUE_HAVE_LIBNUMA)
+  return NumaAvailable() ? (size_t)numa_max_node() + 1 : 1;
+#elif defined(_WIN32)
+  ULONG highest;
+
+  return GetNumaHighestNodeNumber(&highest) ? (size_t)highest + 1 : 1;
+#else
+  return 1;
+#endif
+}
+
+/**
+ * Get NUMA node of the calling thread method
+ * @return node of the processor the thread is running on (0 if it is unknown)
+ * @warning the thread may migrate to another node right after the call
+ */
+inline size_t CurrentNumaNode() noexcept {
+#if defined(DEQUE_HAVE_LIBNUMA)
+  if (!NumaAvailable())
+    return 0;
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+  unsigned int cpu, node;
+
+  return getcpu(&cpu, &node) == 0 ? (size_t)node : 0;
+#else
+  int cpu = sched_getcpu();
+  int node = cpu >= 0 ? numa_node_of_cpu(cpu) : -1;
+
+  return node >= 0 ? (size_t)node : 0;
+#endif
+#elif defined(_WIN32)
+  PROCESSOR_NUMBER processor;
+  USHORT node;
+
+  GetCurrentProcessorNumberEx(&processor);
+
+  return GetNumaProcessorNodeEx(&processor, &node) ? (size_t)node : 0;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Allocate memory bound to NUMA node
+ * @param[in] size number of bytes to allocate (whole pages are taken if NUMA is supported)
+ * @param[in] node node to place the memory on
+ * @return pointer to allocated memory (nullptr if there is no memory)
+ */
+inline void* NumaAlloc(size_t size, size_t node) noexcept {
+#if defined(DEQUE_HAVE_LIBNUMA)
+  return NumaAvailable() ? numa_alloc_onnode(size, (int)node) : malloc(size);
+#elif defined(_WIN32)
+  return VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, (DWORD)node);
+#else
+  (void)node;
+
+  return malloc(size);
+#endif
+}
+
+/**
+ * Free memory allocated by NumaAlloc
+ * @param[in] data pointer to memory
+ * @param[in] size number of bytes passed to NumaAlloc
+ */
+inline void NumaFree(void* data, size_t size) noexcept {
+#if defined(DEQUE_HAVE_LIBNUMA)
+  if (NumaAvailable())
+    numa_free(data, size);
+  else
+    free(data);
+#elif defined(_WIN32)
+  (void)size;
+  VirtualFree(data, 0, MEM_RELEASE);
+#else
+  (void)size;
+  free(data);
+#endif
+}
+
+/**
+ * @brief NUMA slab source
+ *
+ * Slab source of the pool allocator (see basic_pool_allocator_t) that binds slabs to one NUMA node
+ */
+class numa_slab_source_t {
+private:
+  size_t node;                ///< NUMA node slabs are bound to
+public:
+  static constexpr char const* outOfMemory = "NUMA node is out of memory";   ///< message of the exception thrown if there is no memory for a slab
+
+  /**
+   * NUMA slab source constructor
+   * @param[in] node NUMA node to bind slabs to
+   * @exception "NUMA node does not exist" if node is not less than NumaNodeCount()
+   */
+  explicit numa_slab_source_t(size_t node = 0) : node(node) {
+    if (node >= NumaNodeCount())
+      throw exception("NUMA node does not exist");
+  }
+
+  /**
+   * Allocate slab on the node
+   * @param[in] size number of bytes to allocate
+   * @return pointer to allocated memory (nullptr if there is no memory)
+   */
+  void* AllocSlab(size_t size) noexcept {
+    return NumaAlloc(size, node);
+  }
+
+  /**
+   * Free slab
+   * @param[in] data pointer to slab
+   * @param[in] size number of bytes passed to AllocSlab
+   */
+  void FreeSlab(void* data, size_t size) noexcept {
+    NumaFree(data, size);
+  }
+
+  /**
+   * Get NUMA node method
+   * @return node the slabs are bound to
+   */
+  size_t Node() const noexcept {
+    return node;
+  }
+};
+
+/**
+ * @brief NUMA node pool allocator
+ *
+ * Fixed-size pool allocator whose slabs are bound to one NUMA node,
+ * so all nodes of a deque stay in the memory of the socket that works with it.
+ * The slot size is taken from the constructor or from the first request
+ * @warning memory is returned to the system only when the allocator is destroyed
+ * @see basic_pool_allocator_t
+ */
+class numa_allocator_t : public basic_pool_allocator_t<numa_slab_source_t> {
+public:
+  /**
+   * NUMA allocator constructor
+   * @param[in] node NUMA node to bind memory to (node of the calling thread by default)
+   * @param[in] slotSize size of one slot in bytes (0 to take it from the first request)
+   * @param[in] slotsPerSlab number of slots carved from one slab
+   * @exception "NUMA node does not exist" if node is not less than NumaNodeCount()
+   */
+  explicit numa_allocator_t(size_t node = CurrentNumaNode(), size_t slotSize = 0, size_t slotsPerSlab = 1024) :
+    basic_pool_allocator_t(slotSize, slotsPerSlab, ::numa_slab_source_t(node)) {}
+
+  /**
+   * Get NUMA node method
+   * @return node the memory is bound to
+   */
+  size_t Node() const noexcept {
+    return SlabSource().Node();
+  }
+};
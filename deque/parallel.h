@@ -0,0 +1,83 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <exception>
+#include <execution>
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * Minimal number of elements processed by one thread of parallel deque algorithms
+ */
+constexpr size_t parallelMinSegmentSize = 16384;
+
+/**
+ * Get number of threads implied by an execution policy
+ * @tparam policy type of execution policy
+ * @return 1 for sequenced policy, 0 (use all hardware threads) otherwise
+ */
+template <typename policy>
+constexpr unsigned PolicyThreadCount() {
+  return std::is_same_v<std::remove_cvref_t<policy>, std::execution::sequenced_policy> ? 1 : 0;
+}
+
+/**
+ * Get number of segments to split elements into
+ * @param[in] count number of elements
+ * @param[in] threadCount requested number of threads (0 to use all hardware threads)
+ * @return number of segments (at least one, each of at least 'parallelMinSegmentSize' elements if there are several)
+ */
+inline size_t ParallelSegmentCount(size_t count, unsigned threadCount) {
+  size_t segments = threadCount ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+
+  return std::max<size_t>(std::min(segments, count / parallelMinSegmentSize), 1);
+}
+
+/**
+ * Run function for every segment, each segment in its own thread (segment 0 runs in the calling thread)
+ *
+ * All threads are joined before return; the first exception thrown by a segment is rethrown
+ * @tparam func type of function called as func(segment)
+ * @param[in] segments number of segments
+ * @param[in] f function to run
+ */
+template <typename func>
+void RunParallelSegments(size_t segments, func const& f) {
+  std::vector<std::exception_ptr> errors(segments);
+  std::vector<std::thread> threads;
+  auto run = [&](size_t segment) {
+    try {
+      f(segment);
+    }
+    catch (...) {
+      errors[segment] = std::current_exception();
+    }
+  };
+
+  if (segments == 0)
+    return;
+
+  threads.reserve(segments - 1);
+
+  try {
+    for (size_t i = 1; i < segments; i++)
+      threads.emplace_back(run, i);
+  }
+  catch (...) {
+    for (auto& t : threads)
+      t.join();
+
+    throw;
+  }
+
+  run(0);
+
+  for (auto& t : threads)
+    t.join();
+
+  for (auto& e : errors)
+    if (e)
+      std::rethrow_exception(e);
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <new>
+#include <cstddef>
+
+using std::exception;
+
+/**
+ * @brief Bounded ring deque class
+ *
+ * Single-producer single-consumer queue on a contiguous power-of-two buffer stored inside the object.
+ * The producer calls PushBack, the consumer calls PopFront/PeekHead, both sides are wait-free.
+ * Head and tail indices live on separate cache lines together with a cached copy of the other index,
+ * so the sides touch shared lines only when the cached copy says the buffer is full or empty
+ * @tparam elemType type of stored elements
+ * @tparam capacity maximum number of elements (power of two)
+ */
+template <typename elemType, size_t capacity>
+class ring_deque_t {
+private:
+  static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "Ring deque capacity must be a power of two");
+
+  static constexpr size_t cacheLineSize = 64;   ///< assumed size of a cache line
+  static constexpr size_t mask = capacity - 1;  ///< mask turning index into slot number
+
+  alignas(cacheLineSize) std::atomic<size_t> head;    ///< index of the first element (written by consumer)
+  size_t cachedTail;                                  ///< consumer's copy of tail
+  alignas(cacheLineSize) std::atomic<size_t> tail;    ///< index after the last element (written by producer)
+  size_t cachedHead;                                  ///< producer's copy of head
+  alignas(cacheLineSize > alignof(elemType) ? cacheLineSize : alignof(elemType))
+    unsigned char storage[capacity * sizeof(elemType)];   ///< element slots
+
+  /**
+   * Get slot by index
+   * @param[in] index element index
+   * @return pointer to the element storage
+   */
+  elemType* Slot(size_t index) noexcept {
+    return (elemType*)storage + (index & mask);
+  }
+
+  /**
+   * Check that consumer has an element, refreshing cached tail if necessary (consumer only)
+   * @param[in] h index of the first element
+   * @return true if deque has an element, false otherwise
+   */
+  bool HasElement(size_t h) noexcept {
+    if (h == cachedTail)
+      cachedTail = tail.load(std::memory_order_acquire);
+
+    return h != cachedTail;
+  }
+public:
+  /**
+   * Default deque constructor
+   */
+  ring_deque_t() : head(0), cachedTail(0), tail(0), cachedHead(0) {}
+
+  ring_deque_t(ring_deque_t const&) = delete;
+  ring_deque_t& operator=(ring_deque_t const&) = delete;
+
+  /**
+   * Get deque capacity method
+   * @return maximum number of elements
+   */
+  static constexpr size_t Capacity() noexcept {
+    return capacity;
+  }
+
+  /**
+   * Get deque size method
+   * @return number of elements in the deque (a snapshot that may be outdated at once)
+   */
+  size_t Size() const noexcept {
+    size_t h = head.load(std::memory_order_acquire);
+    size_t t = tail.load(std::memory_order_acquire);
+
+    return t - h;
+  }
+
+  /**
+   * Check is deque empty method
+   * @return true if deque is empty, false otherwise (a snapshot that may be outdated at once)
+   */
+  bool IsEmpty() const noexcept {
+    return Size() == 0;
+  }
+
+  /**
+   * Method to construct element at end of deque if there is room (producer only)
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @returns true if the element was put, false if deque is full
+   */
+  template <typename... args>
+  bool TryEmplaceBack(args&&... params) {
+    size_t t = tail.load(std::memory_order_relaxed);
+
+    if (t - cachedHead == capacity) {
+      cachedHead = head.load(std::memory_order_acquire);
+
+      if (t - cachedHead == capacity)
+        return false;
+    }
+
+    new ((void*)Slot(t)) elemType(std::forward<args>(params)...);
+    tail.store(t + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  /**
+   * Method put element to end of deque if there is room (copy semantics, producer only)
+   * @param[in] elem const reference on element
+   * @returns true if the element was put, false if deque is full
+   */
+  bool TryPushBack(elemType const& elem) {
+    return TryEmplaceBack(elem);
+  }
+
+  /**
+   * Method put element to end of deque if there is room (move semantics, producer only)
+   * @param[in] elem rvalue reference on element
+   * @returns true if the element was put, false if deque is full
+   */
+  bool TryPushBack(elemType&& elem) {
+    return TryEmplaceBack(std::move(elem));
+  }
+
+  /**
+   * Method put element to end of deque (copy semantics, producer only)
+   * @param[in] elem const reference on element
+   * @exception "Deque is full" if deque is full
+   */
+  void PushBack(elemType const& elem) {
+    if (!TryEmplaceBack(elem))
+      throw exception("Deque is full");
+  }
+
+  /**
+   * Method put element to end of deque (move semantics, producer only)
+   * @param[in] elem rvalue reference on element
+   * @exception "Deque is full" if deque is full
+   */
+  void PushBack(elemType&& elem) {
+    if (!TryEmplaceBack(std::move(elem)))
+      throw exception("Deque is full");
+  }
+
+  /**
+   * Method to see what first element is (consumer only)
+   * @returns const reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType const& PeekHead() {
+    size_t h = head.load(std::memory_order_relaxed);
+
+    if (!HasElement(h))
+      throw exception("Deque is empty");
+
+    return *Slot(h);
+  }
+
+  /**
+   * Method to take first element from deque (consumer only)
+   * @returns moved first element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopFront() {
+    size_t h = head.load(std::memory_order_relaxed);
+
+    if (!HasElement(h))
+      return std::nullopt;
+
+    elemType* elem = Slot(h);
+    std::optional<elemType> result(std::move(*elem));
+
+    elem->~elemType();
+    head.store(h + 1, std::memory_order_release);
+
+    return result;
+  }
+
+  /**
+   * Method to remove first element from deque (consumer only)
+   * @exception "Deque is empty" if deque is empty
+   */
+  void PopFront() {
+    size_t h = head.load(std::memory_order_relaxed);
+
+    if (!HasElement(h))
+      throw exception("Deque is empty");
+
+    Slot(h)->~elemType();
+    head.store(h + 1, std::memory_order_release);
+  }
+
+  /**
+   * Deque destructor (must not run concurrently with other methods)
+   */
+  ~ring_deque_t() {
+    size_t t = tail.load(std::memory_order_relaxed);
+
+    for (size_t h = head.load(std::memory_order_relaxed); h != t; h++)
+      Slot(h)->~elemType();
+  }
+};
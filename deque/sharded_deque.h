@@ -0,0 +1,244 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+#include "deque.h"
+#include "concurrent_deque.h"
+#include "numa_allocator.h"
+
+/**
+ * @brief NUMA-sharded deque class
+ *
+ * Multi-producer multi-consumer deque made of one deque_t per NUMA node, each with its own lock
+ * and nodes allocated from memory of that NUMA node. Pushes go to a shard of the calling thread's node;
+ * pops take from the local shard and steal from other shards when it is empty.
+ * The order of elements is kept only within a shard
+ * @tparam elemType type of stored elements
+ * @see numa_allocator_t
+ */
+template <typename elemType>
+class sharded_deque_t {
+private:
+  /**
+   * @brief Shard struct
+   *
+   * Deque of one NUMA node (aligned to a cache line to keep locks of shards apart)
+   */
+  struct alignas(64) shard_t {
+    spin_lock_t lock;                                ///< lock of the shard
+    deque_t<elemType, numa_allocator_t> deque;       ///< elements of the shard
+
+    /**
+     * Shard constructor
+     * @param[in] node NUMA node to allocate elements on
+     */
+    explicit shard_t(size_t node) : deque(numa_allocator_t(node)) {}
+  };
+
+  std::vector<std::unique_ptr<shard_t>> shards;   ///< shards (shard i works with node i % nodes)
+  size_t nodes;                                   ///< number of NUMA nodes
+  std::atomic<ptrdiff_t> size;                    ///< number of elements (may be negative for a moment)
+
+  /**
+   * Get hash of the calling thread method
+   * @return hash of the number given to the calling thread by its first call (the same for all deques)
+   */
+  static size_t ThreadHash() noexcept {
+    static std::atomic<uint64_t> threads(0);
+    thread_local size_t const hash = (size_t)((threads.fetch_add(1, std::memory_order_relaxed) * 0x9E3779B97F4A7C15ull) >> 32);
+
+    return hash;
+  }
+
+  /**
+   * Take element from the local shard or steal it from others
+   * @param[in] front true to take first elements of shards, false to take last ones
+   * @returns moved element or std::nullopt if all shards are empty
+   */
+  std::optional<elemType> Take(bool front) {
+    size_t local = LocalShard();
+
+    for (size_t i = 0; i < shards.size(); i++) {
+      shard_t& shard = *shards[(local + i) % shards.size()];
+      std::lock_guard<spin_lock_t> guard(shard.lock);
+      std::optional<elemType> result = front ? shard.deque.TryPopFront() : shard.deque.TryPopBack();
+
+      if (result) {
+        size.fetch_sub(1, std::memory_order_release);
+        return result;
+      }
+    }
+
+    return std::nullopt;
+  }
+public:
+  /**
+   * Default deque constructor (one shard per NUMA node)
+   */
+  sharded_deque_t() : sharded_deque_t(NumaNodeCount()) {}
+
+  /**
+   * Constructor with number of shards
+   * @param[in] shardCount number of shards (at least one; if there are more shards than nodes, every node gets
+   * several shards and threads of the node are spread over them)
+   */
+  explicit sharded_deque_t(size_t shardCount) : nodes(NumaNodeCount()), size(0) {
+    for (size_t i = 0; i < (shardCount > 0 ? shardCount : 1); i++)
+      shards.push_back(std::make_unique<shard_t>(i % nodes));
+  }
+
+  sharded_deque_t(sharded_deque_t const&) = delete;
+  sharded_deque_t& operator=(sharded_deque_t const&) = delete;
+
+  /**
+   * Get number of shards method
+   * @return number of shards
+   */
+  size_t ShardCount() const noexcept {
+    return shards.size();
+  }
+
+  /**
+   * Get shard of the calling thread method
+   *
+   * Shards of a node are node, node + nodes, node + 2 * nodes and so on; a thread always picks the same one of them
+   * by its hash, so threads of one node are spread over all its shards
+   * @return index of the shard pushes of the calling thread go to
+   */
+  size_t LocalShard() const noexcept {
+    size_t node = CurrentNumaNode();
+
+    if (node >= shards.size())
+      return node % shards.size();
+
+    size_t nodeShards = (shards.size() - node + nodes - 1) / nodes;
+
+    return node + ThreadHash() % nodeShards * nodes;
+  }
+
+  /**
+   * Get deque size method
+   * @return number of elements in all shards (a snapshot that may be outdated at once)
+   */
+  size_t Size() const noexcept {
+    ptrdiff_t count = size.load(std::memory_order_acquire);
+
+    return count > 0 ? (size_t)count : 0;
+  }
+
+  /**
+   * Check is deque empty method
+   * @return true if deque is empty, false otherwise (a snapshot that may be outdated at once)
+   */
+  bool IsEmpty() const noexcept {
+    return Size() == 0;
+  }
+
+  /**
+   * Method to construct element at begin of the local shard
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   */
+  template <typename... args>
+  void EmplaceFront(args&&... params) {
+    shard_t& shard = *shards[LocalShard()];
+    std::lock_guard<spin_lock_t> guard(shard.lock);
+
+    shard.deque.EmplaceFront(std::forward<args>(params)...);
+    size.fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   * Method to construct element at end of the local shard
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   */
+  template <typename... args>
+  void EmplaceBack(args&&... params) {
+    shard_t& shard = *shards[LocalShard()];
+    std::lock_guard<spin_lock_t> guard(shard.lock);
+
+    shard.deque.EmplaceBack(std::forward<args>(params)...);
+    size.fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   * Method put element to begin of the local shard (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushFront(elemType const& elem) {
+    EmplaceFront(elem);
+  }
+
+  /**
+   * Method put element to begin of the local shard (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushFront(elemType&& elem) {
+    EmplaceFront(std::move(elem));
+  }
+
+  /**
+   * Method put element to end of the local shard (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushBack(elemType const& elem) {
+    EmplaceBack(elem);
+  }
+
+  /**
+   * Method put element to end of the local shard (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushBack(elemType&& elem) {
+    EmplaceBack(std::move(elem));
+  }
+
+  /**
+   * Method to take first element of the local shard (or of the next non-empty shard if it is empty)
+   * @returns moved element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopFront() {
+    return Take(true);
+  }
+
+  /**
+   * Method to take last element of the local shard (or of the next non-empty shard if it is empty)
+   * @returns moved element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopBack() {
+    return Take(false);
+  }
+
+  /**
+   * Call function for all elements, shard by shard (each shard is locked while it is walked)
+   * @tparam func type of function called as func(elem)
+   * @param[in] f function to call
+   */
+  template <typename func>
+  void ForEach(func&& f) {
+    for (auto& shard : shards) {
+      std::lock_guard<spin_lock_t> guard(shard->lock);
+
+      for (elemType& elem : shard->deque)
+        f(elem);
+    }
+  }
+
+  /**
+   * Remove all elements
+   */
+  void Clear() {
+    for (auto& shard : shards) {
+      std::lock_guard<spin_lock_t> guard(shard->lock);
+
+      size.fetch_sub((ptrdiff_t)shard->deque.Size(), std::memory_order_release);
+      shard->deque.Clear();
+    }
+  }
+};
@@ -0,0 +1,492 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DEQUE_SIMD_X86 1
+#define DEQUE_SIMD_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define DEQUE_SIMD_X86 1
+#define DEQUE_SIMD_AVX2_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#define DEQUE_SIMD_X86 0
+#endif
+
+/**
+ * @brief Instruction set used by bulk kernels
+ */
+enum class simd_level_t {
+  scalar,   ///< portable loops (vectorized by the compiler where the target allows)
+  avx2      ///< AVX2 kernels selected at run time
+};
+
+/**
+ * Detect the best instruction set supported by the CPU and the OS
+ * @return detected instruction set
+ */
+inline simd_level_t DetectSimdLevel() noexcept {
+#if DEQUE_SIMD_X86 && defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return simd_level_t::scalar;
+
+  __cpuid(info, 1);
+  bool osAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+
+  __cpuidex(info, 7, 0);
+
+  return osAvx && (info[1] & (1 << 5)) ? simd_level_t::avx2 : simd_level_t::scalar;
+#elif DEQUE_SIMD_X86
+  return __builtin_cpu_supports("avx2") ? simd_level_t::avx2 : simd_level_t::scalar;
+#else
+  return simd_level_t::scalar;
+#endif
+}
+
+/**
+ * Get storage of the instruction set used by bulk kernels
+ * @return reference on current instruction set (detected on the first call)
+ */
+inline std::atomic<simd_level_t>& CurrentSimdLevel() noexcept {
+  static std::atomic<simd_level_t> level = DetectSimdLevel();
+
+  return level;
+}
+
+/**
+ * Get instruction set used by bulk kernels
+ * @return current instruction set
+ */
+inline simd_level_t SimdLevel() noexcept {
+  return CurrentSimdLevel().load(std::memory_order_relaxed);
+}
+
+/**
+ * Select instruction set used by bulk kernels (e.g. to compare kernels in benchmarks)
+ * @param[in] level required instruction set (lowered to the detected one if the CPU does not support it)
+ */
+inline void SetSimdLevel(simd_level_t level) noexcept {
+  CurrentSimdLevel().store(level <= DetectSimdLevel() ? level : DetectSimdLevel(), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Sum type of bulk kernels
+ *
+ * 64-bit integer for integral types (so sums of small integers do not overflow), the type itself for floating point
+ */
+template <typename type>
+using simd_sum_t = std::conditional_t<std::is_floating_point_v<type>, type,
+  std::conditional_t<std::is_signed_v<type>, int64_t, uint64_t>>;
+
+/**
+ * Scalar sum of elements
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements
+ * @return sum of elements
+ */
+template <typename type>
+simd_sum_t<type> ScalarSum(const type* data, size_t count) noexcept {
+  simd_sum_t<type> sum = 0;
+
+  for (size_t i = 0; i < count; i++)
+    sum += data[i];
+
+  return sum;
+}
+
+/**
+ * Scalar minimum of elements
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements (at least one)
+ * @return minimal element
+ */
+template <typename type>
+type ScalarMin(const type* data, size_t count) noexcept {
+  type result = data[0];
+
+  for (size_t i = 1; i < count; i++)
+    result = data[i] < result ? data[i] : result;
+
+  return result;
+}
+
+/**
+ * Scalar maximum of elements
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements (at least one)
+ * @return maximal element
+ */
+template <typename type>
+type ScalarMax(const type* data, size_t count) noexcept {
+  type result = data[0];
+
+  for (size_t i = 1; i < count; i++)
+    result = result < data[i] ? data[i] : result;
+
+  return result;
+}
+
+/**
+ * Scalar search of value
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements
+ * @param[in] value value to find
+ * @return index of the first element equal to value ('count' if there is no such element)
+ */
+template <typename type>
+size_t ScalarFind(const type* data, size_t count, type value) noexcept {
+  for (size_t i = 0; i < count; i++)
+    if (data[i] == value)
+      return i;
+
+  return count;
+}
+
+/**
+ * Scalar count of value
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements
+ * @param[in] value value to count
+ * @return number of elements equal to value
+ */
+template <typename type>
+size_t ScalarCount(const type* data, size_t count, type value) noexcept {
+  size_t result = 0;
+
+  for (size_t i = 0; i < count; i++)
+    result += data[i] == value;
+
+  return result;
+}
+
+/**
+ * Scalar fill with value
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements
+ * @param[in] value value to assign
+ */
+template <typename type>
+void ScalarFill(type* data, size_t count, type value) noexcept {
+  for (size_t i = 0; i < count; i++)
+    data[i] = value;
+}
+
+#if DEQUE_SIMD_X86
+/**
+ * @brief AVX2 operations for element type
+ *
+ * Defined for int32_t, int64_t, float and double; other types use scalar kernels
+ */
+template <typename type>
+struct avx2_ops_t;
+
+template <>
+struct avx2_ops_t<int32_t> {
+  using vec_t = __m256i;
+  using acc_t = __m256i;
+  static constexpr size_t lanes = 8;
+
+  DEQUE_SIMD_AVX2_TARGET static vec_t Load(const int32_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+  DEQUE_SIMD_AVX2_TARGET static void Store(int32_t* p, vec_t v) { _mm256_storeu_si256((__m256i*)p, v); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Set(int32_t x) { return _mm256_set1_epi32(x); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Min(vec_t a, vec_t b) { return _mm256_min_epi32(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Max(vec_t a, vec_t b) { return _mm256_max_epi32(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static unsigned Equal(vec_t a, vec_t b) {
+    return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+  }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Zero() { return _mm256_setzero_si256(); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Add(acc_t a, acc_t b) { return _mm256_add_epi64(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Widen(vec_t v) {
+    return _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)), _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+  }
+  DEQUE_SIMD_AVX2_TARGET static int64_t Total(acc_t a) {
+    alignas(32) int64_t parts[4];
+
+    _mm256_store_si256((__m256i*)parts, a);
+
+    return parts[0] + parts[1] + parts[2] + parts[3];
+  }
+};
+
+template <>
+struct avx2_ops_t<int64_t> {
+  using vec_t = __m256i;
+  using acc_t = __m256i;
+  static constexpr size_t lanes = 4;
+
+  DEQUE_SIMD_AVX2_TARGET static vec_t Load(const int64_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+  DEQUE_SIMD_AVX2_TARGET static void Store(int64_t* p, vec_t v) { _mm256_storeu_si256((__m256i*)p, v); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Set(int64_t x) { return _mm256_set1_epi64x(x); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Min(vec_t a, vec_t b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Max(vec_t a, vec_t b) { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+  DEQUE_SIMD_AVX2_TARGET static unsigned Equal(vec_t a, vec_t b) {
+    return (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+  }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Zero() { return _mm256_setzero_si256(); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Add(acc_t a, acc_t b) { return _mm256_add_epi64(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Widen(vec_t v) { return v; }
+  DEQUE_SIMD_AVX2_TARGET static int64_t Total(acc_t a) {
+    alignas(32) int64_t parts[4];
+
+    _mm256_store_si256((__m256i*)parts, a);
+
+    return parts[0] + parts[1] + parts[2] + parts[3];
+  }
+};
+
+template <>
+struct avx2_ops_t<float> {
+  using vec_t = __m256;
+  using acc_t = __m256;
+  static constexpr size_t lanes = 8;
+
+  DEQUE_SIMD_AVX2_TARGET static vec_t Load(const float* p) { return _mm256_loadu_ps(p); }
+  DEQUE_SIMD_AVX2_TARGET static void Store(float* p, vec_t v) { _mm256_storeu_ps(p, v); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Set(float x) { return _mm256_set1_ps(x); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Min(vec_t a, vec_t b) { return _mm256_min_ps(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Max(vec_t a, vec_t b) { return _mm256_max_ps(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static unsigned Equal(vec_t a, vec_t b) { return (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Zero() { return _mm256_setzero_ps(); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Add(acc_t a, acc_t b) { return _mm256_add_ps(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Widen(vec_t v) { return v; }
+  DEQUE_SIMD_AVX2_TARGET static float Total(acc_t a) {
+    alignas(32) float parts[8];
+
+    _mm256_store_ps(parts, a);
+
+    return ((parts[0] + parts[1]) + (parts[2] + parts[3])) + ((parts[4] + parts[5]) + (parts[6] + parts[7]));
+  }
+};
+
+template <>
+struct avx2_ops_t<double> {
+  using vec_t = __m256d;
+  using acc_t = __m256d;
+  static constexpr size_t lanes = 4;
+
+  DEQUE_SIMD_AVX2_TARGET static vec_t Load(const double* p) { return _mm256_loadu_pd(p); }
+  DEQUE_SIMD_AVX2_TARGET static void Store(double* p, vec_t v) { _mm256_storeu_pd(p, v); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Set(double x) { return _mm256_set1_pd(x); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Min(vec_t a, vec_t b) { return _mm256_min_pd(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static vec_t Max(vec_t a, vec_t b) { return _mm256_max_pd(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static unsigned Equal(vec_t a, vec_t b) { return (unsigned)_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Zero() { return _mm256_setzero_pd(); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Add(acc_t a, acc_t b) { return _mm256_add_pd(a, b); }
+  DEQUE_SIMD_AVX2_TARGET static acc_t Widen(vec_t v) { return v; }
+  DEQUE_SIMD_AVX2_TARGET static double Total(acc_t a) {
+    alignas(32) double parts[4];
+
+    _mm256_store_pd(parts, a);
+
+    return (parts[0] + parts[1]) + (parts[2] + parts[3]);
+  }
+};
+
+/**
+ * Check that element type has AVX2 kernels
+ */
+template <typename type>
+concept avx2_element = std::is_same_v<type, int32_t> || std::is_same_v<type, int64_t> ||
+  std::is_same_v<type, float> || std::is_same_v<type, double>;
+
+/**
+ * AVX2 sum of elements (two independent accumulators hide addition latency)
+ */
+template <avx2_element type>
+DEQUE_SIMD_AVX2_TARGET simd_sum_t<type> Avx2Sum(const type* data, size_t count) noexcept {
+  using ops = avx2_ops_t<type>;
+  typename ops::acc_t acc0 = ops::Zero(), acc1 = ops::Zero();
+  size_t i = 0;
+
+  for (; i + 2 * ops::lanes <= count; i += 2 * ops::lanes) {
+    acc0 = ops::Add(acc0, ops::Widen(ops::Load(data + i)));
+    acc1 = ops::Add(acc1, ops::Widen(ops::Load(data + i + ops::lanes)));
+  }
+  for (; i + ops::lanes <= count; i += ops::lanes)
+    acc0 = ops::Add(acc0, ops::Widen(ops::Load(data + i)));
+
+  simd_sum_t<type> sum = ops::Total(ops::Add(acc0, acc1));
+
+  for (; i < count; i++)
+    sum += data[i];
+
+  return sum;
+}
+
+/**
+ * AVX2 minimum or maximum of elements
+ * @tparam isMin true for minimum, false for maximum
+ */
+template <bool isMin, avx2_element type>
+DEQUE_SIMD_AVX2_TARGET type Avx2MinMax(const type* data, size_t count) noexcept {
+  using ops = avx2_ops_t<type>;
+
+  if (count < ops::lanes)
+    return isMin ? ScalarMin(data, count) : ScalarMax(data, count);
+
+  typename ops::vec_t acc = ops::Load(data);
+  size_t i = ops::lanes;
+
+  for (; i + ops::lanes <= count; i += ops::lanes)
+    acc = isMin ? ops::Min(acc, ops::Load(data + i)) : ops::Max(acc, ops::Load(data + i));
+
+  type parts[ops::lanes];
+
+  ops::Store(parts, acc);
+
+  type result = isMin ? ScalarMin(parts, ops::lanes) : ScalarMax(parts, ops::lanes);
+
+  for (; i < count; i++)
+    result = isMin ? (data[i] < result ? data[i] : result) : (result < data[i] ? data[i] : result);
+
+  return result;
+}
+
+/**
+ * AVX2 search of value
+ */
+template <avx2_element type>
+DEQUE_SIMD_AVX2_TARGET size_t Avx2Find(const type* data, size_t count, type value) noexcept {
+  using ops = avx2_ops_t<type>;
+  typename ops::vec_t v = ops::Set(value);
+  size_t i = 0;
+
+  for (; i + ops::lanes <= count; i += ops::lanes)
+    if (unsigned mask = ops::Equal(ops::Load(data + i), v))
+      return i + (size_t)std::countr_zero(mask);
+
+  for (; i < count; i++)
+    if (data[i] == value)
+      return i;
+
+  return count;
+}
+
+/**
+ * AVX2 count of value
+ */
+template <avx2_element type>
+DEQUE_SIMD_AVX2_TARGET size_t Avx2Count(const type* data, size_t count, type value) noexcept {
+  using ops = avx2_ops_t<type>;
+  typename ops::vec_t v = ops::Set(value);
+  size_t result = 0, i = 0;
+
+  for (; i + ops::lanes <= count; i += ops::lanes)
+    result += (size_t)std::popcount(ops::Equal(ops::Load(data + i), v));
+
+  for (; i < count; i++)
+    result += data[i] == value;
+
+  return result;
+}
+
+#endif
+
+/**
+ * Sum of elements (AVX2 kernel for int32_t, int64_t, float and double if the CPU supports it)
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements
+ * @return sum of elements (floating point sums may differ from sequential order in rounding)
+ */
+template <typename type>
+simd_sum_t<type> SimdSum(const type* data, size_t count) noexcept {
+#if DEQUE_SIMD_X86
+  if constexpr (avx2_element<type>)
+    if (SimdLevel() == simd_level_t::avx2)
+      return Avx2Sum(data, count);
+#endif
+
+  return ScalarSum(data, count);
+}
+
+/**
+ * Minimum of elements (AVX2 kernel for int32_t, int64_t, float and double if the CPU supports it)
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements (at least one)
+ * @return minimal element (result is unspecified if elements contain NaN)
+ */
+template <typename type>
+type SimdMin(const type* data, size_t count) noexcept {
+#if DEQUE_SIMD_X86
+  if constexpr (avx2_element<type>)
+    if (SimdLevel() == simd_level_t::avx2)
+      return Avx2MinMax<true>(data, count);
+#endif
+
+  return ScalarMin(data, count);
+}
+
+/**
+ * Maximum of elements (AVX2 kernel for int32_t, int64_t, float and double if the CPU supports it)
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements (at least one)
+ * @return maximal element (result is unspecified if elements contain NaN)
+ */
+template <typename type>
+type SimdMax(const type* data, size_t count) noexcept {
+#if DEQUE_SIMD_X86
+  if constexpr (avx2_element<type>)
+    if (SimdLevel() == simd_level_t::avx2)
+      return Avx2MinMax<false>(data, count);
+#endif
+
+  return ScalarMax(data, count);
+}
+
+/**
+ * Search of value (AVX2 kernel for int32_t, int64_t, float and double if the CPU supports it)
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements
+ * @param[in] value value to find
+ * @return index of the first element equal to value ('count' if there is no such element)
+ */
+template <typename type>
+size_t SimdFind(const type* data, size_t count, type value) noexcept {
+#if DEQUE_SIMD_X86
+  if constexpr (avx2_element<type>)
+    if (SimdLevel() == simd_level_t::avx2)
+      return Avx2Find(data, count, value);
+#endif
+
+  return ScalarFind(data, count, value);
+}
+
+/**
+ * Count of value (AVX2 kernel for int32_t, int64_t, float and double if the CPU supports it)
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements
+ * @param[in] value value to count
+ * @return number of elements equal to value
+ */
+template <typename type>
+size_t SimdCount(const type* data, size_t count, type value) noexcept {
+#if DEQUE_SIMD_X86
+  if constexpr (avx2_element<type>)
+    if (SimdLevel() == simd_level_t::avx2)
+      return Avx2Count(data, count, value);
+#endif
+
+  return ScalarCount(data, count, value);
+}
+
+/**
+ * Fill with value
+ *
+ * Always uses the scalar loop: compilers turn it into vector stores or memset, and AVX2 stores were not faster
+ * @param[in] data pointer to elements
+ * @param[in] count number of elements
+ * @param[in] value value to assign
+ */
+template <typename type>
+void SimdFill(type* data, size_t count, type value) noexcept {
+  ScalarFill(data, count, value);
+}
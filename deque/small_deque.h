@@ -0,0 +1,883 @@
+#pragma once
+
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <new>
+#include <cstddef>
+#include "block_deque.h"
+
+using std::exception;
+
+/**
+ * @brief Small deque class
+ *
+ * Keeps up to 'inlineCapacity' elements in a ring buffer inside the object, so small deques make no allocations.
+ * When an element does not fit, all elements move to a block deque and the deque stays there until ShrinkToFit
+ * @tparam elemType type of stored elements
+ * @tparam inlineCapacity number of elements stored inside the object
+ * @tparam memoryAllocator the allocator used after overflow (allocator based on malloc/free is used by default)
+ * @see block_deque_t
+ */
+template <typename elemType, size_t inlineCapacity, deque_allocator memoryAllocator = simple_allocator_t>
+class small_deque_t {
+private:
+  static_assert(inlineCapacity > 0, "Small deque must store at least one element inline");
+
+  using heap_t = block_deque_t<elemType, memoryAllocator>;
+
+  alignas(elemType) unsigned char storage[inlineCapacity * sizeof(elemType)];   ///< inline element slots
+  size_t first;                 ///< slot of the first inline element
+  size_t size;                  ///< number of inline elements
+  bool isInline;                ///< true if elements are stored inline, false if they are in 'heap'
+  heap_t heap;                  ///< storage used after overflow
+
+  /**
+   * Get inline slot of element
+   * @param[in] index index of element
+   * @return pointer to the element storage
+   */
+  elemType* Slot(size_t index) noexcept {
+    return (elemType*)storage + (first + index) % inlineCapacity;
+  }
+
+  /**
+   * Get inline slot of element
+   * @param[in] index index of element
+   * @return pointer to the element storage
+   */
+  elemType const* Slot(size_t index) const noexcept {
+    return (elemType const*)storage + (first + index) % inlineCapacity;
+  }
+
+  /**
+   * Destroy inline elements
+   */
+  void DestroyInline() noexcept {
+    for (size_t i = 0; i < size; i++)
+      Slot(i)->~elemType();
+
+    first = 0;
+    size = 0;
+  }
+
+  /**
+   * Move inline elements to the heap storage (the deque is not changed if an element constructor throws)
+   * @param[in] extra number of elements expected to be added after overflow
+   */
+  void Spill(size_t extra) {
+    try {
+      heap.Reserve(0, size + extra);
+
+      for (size_t i = 0; i < size; i++)
+        heap.PushBack(std::move_if_noexcept(*Slot(i)));
+    }
+    catch (...) {
+      heap.Clear();
+      throw;
+    }
+
+    DestroyInline();
+    isInline = false;
+  }
+
+  /**
+   * Take inline elements of other deque leaving it empty and inline (heap storage must be already moved)
+   * @param[in] deque reference on deque to take elements from
+   */
+  void Steal(small_deque_t& deque) noexcept(std::is_nothrow_move_constructible_v<elemType>) {
+    isInline = deque.isInline;
+
+    if (isInline)
+      for (; size < deque.size; size++)
+        new ((void*)Slot(size)) elemType(std::move(*deque.Slot(size)));
+
+    deque.DestroyInline();
+    deque.isInline = true;
+  }
+public:
+  /**
+   * @brief Small deque iterator
+   *
+   * Allows to iterate in direct order in deque
+   */
+  class iterator {
+  private:
+    small_deque_t* deque;   ///< Pointer to the deque
+    size_t index;           ///< Index of the element to which the iterator corresponds
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;   ///< iterator category for standard algorithms
+    using value_type = elemType;                                 ///< type of elements
+    using difference_type = ptrdiff_t;                           ///< type of distance between iterators
+    using pointer = elemType*;                                   ///< pointer to element
+    using reference = elemType&;                                 ///< reference on element
+
+    /**
+     * Default constructor for iterator
+     */
+    iterator() : deque(nullptr), index(0) {}
+
+    /**
+     * Constructor from deque and index
+     * @param[in] deque pointer to the deque
+     * @param[in] index index of the element we want to build iterator from
+     */
+    iterator(small_deque_t* deque, size_t index) : deque(deque), index(index) {}
+
+    /**
+     * Prefix ++ operator
+     * @return reference to next iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (index >= deque->Size())
+          throw exception("Try to use end iterator");
+
+      index++;
+
+      return *this;
+    }
+
+    /**
+     * Postfix ++ operator
+     * @return reference to current iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    iterator operator++(int) noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      ++*this;
+
+      return tmp;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to previous iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    iterator& operator--() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (index == 0)
+          throw exception("Iterator is out of range");
+
+      index--;
+
+      return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    iterator operator--(int) noexcept(!checkedIterators) {
+      iterator tmp = *this;
+
+      --*this;
+
+      return tmp;
+    }
+
+    /**
+     * Comparison operator ==
+     * @param[in] iter iterator we want to compare with
+     * @return true if equals, false otherwise
+     */
+    bool operator==(iterator const& iter) const noexcept {
+      return index == iter.index;
+    }
+
+    /**
+     * Comparison operator !=
+     * @param[in] iter iterator we want to compare with
+     * @return false if equals, true otherwise
+     */
+    bool operator!=(iterator const& iter) const noexcept {
+      return index != iter.index;
+    }
+
+    /**
+     * Operator *
+     * @return reference on value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType& operator*() const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (index >= deque->Size())
+          throw exception("Try to use end iterator");
+
+      return (*deque)[index];
+    }
+
+    /**
+     * Operator ->
+     * @return pointer to value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType* operator->() const noexcept(!checkedIterators) {
+      return &**this;
+    }
+  };
+
+  /**
+   * Method begin for iterator
+   * @return iterator that corresponds first element
+   */
+  iterator begin() {
+    return iterator(this, 0);
+  }
+
+  /**
+   * Method end for iterator
+   * @return iterator that corresponds element after last
+   */
+  iterator end() {
+    return iterator(this, Size());
+  }
+
+  /**
+   * @brief Small deque const iterator
+   *
+   * Allows to iterate in direct order in deque (does not allow changing elements)
+   */
+  class const_iterator {
+  private:
+    small_deque_t const* deque;   ///< Pointer to the deque
+    size_t index;                 ///< Index of the element to which the iterator corresponds
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;   ///< iterator category for standard algorithms
+    using value_type = elemType;                                 ///< type of elements
+    using difference_type = ptrdiff_t;                           ///< type of distance between iterators
+    using pointer = elemType const*;                             ///< pointer to element
+    using reference = elemType const&;                           ///< reference on element
+
+    /**
+     * Default constructor for const iterator
+     */
+    const_iterator() : deque(nullptr), index(0) {}
+
+    /**
+     * Constructor from deque and index
+     * @param[in] deque pointer to the deque
+     * @param[in] index index of the element we want to build iterator from
+     */
+    const_iterator(small_deque_t const* deque, size_t index) : deque(deque), index(index) {}
+
+    /**
+     * Prefix ++ operator
+     * @return reference to next iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    const_iterator& operator++() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (index >= deque->Size())
+          throw exception("Try to use end iterator");
+
+      index++;
+
+      return *this;
+    }
+
+    /**
+     * Postfix ++ operator
+     * @return reference to current iterator
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    const_iterator operator++(int) noexcept(!checkedIterators) {
+      const_iterator tmp = *this;
+
+      ++*this;
+
+      return tmp;
+    }
+
+    /**
+     * Prefix -- operator
+     * @return reference to previous iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    const_iterator& operator--() noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (index == 0)
+          throw exception("Iterator is out of range");
+
+      index--;
+
+      return *this;
+    }
+
+    /**
+     * Postfix -- operator
+     * @return reference to current iterator
+     * @exception "Iterator is out of range" if iterator corresponds first element (checked iterators only)
+     */
+    const_iterator operator--(int) noexcept(!checkedIterators) {
+      const_iterator tmp = *this;
+
+      --*this;
+
+      return tmp;
+    }
+
+    /**
+     * Comparison operator ==
+     * @param[in] iter iterator we want to compare with
+     * @return true if equals, false otherwise
+     */
+    bool operator==(const_iterator const& iter) const noexcept {
+      return index == iter.index;
+    }
+
+    /**
+     * Comparison operator !=
+     * @param[in] iter iterator we want to compare with
+     * @return false if equals, true otherwise
+     */
+    bool operator!=(const_iterator const& iter) const noexcept {
+      return index != iter.index;
+    }
+
+    /**
+     * Operator *
+     * @return const reference on value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType const& operator*() const noexcept(!checkedIterators) {
+      if constexpr (checkedIterators)
+        if (index >= deque->Size())
+          throw exception("Try to use end iterator");
+
+      return (*deque)[index];
+    }
+
+    /**
+     * Operator ->
+     * @return pointer to value to which the iterator corresponds
+     * @exception "Try to use end iterator" if iterator is end (checked iterators only)
+     */
+    elemType const* operator->() const noexcept(!checkedIterators) {
+      return &**this;
+    }
+  };
+
+  /**
+   * Method begin for const iterator
+   * @return const iterator that corresponds first element
+   */
+  const_iterator begin() const {
+    return const_iterator(this, 0);
+  }
+
+  /**
+   * Method end for const iterator
+   * @return const iterator that corresponds element after last
+   */
+  const_iterator end() const {
+    return const_iterator(this, Size());
+  }
+
+  /**
+   * Default deque constructor
+   */
+  small_deque_t() : first(0), size(0), isInline(true) {}
+
+  /**
+   * Constructor with allocator
+   * @param[in] allocator allocator to be used after overflow
+   */
+  explicit small_deque_t(memoryAllocator const& allocator) : first(0), size(0), isInline(true), heap(allocator) {}
+
+  /**
+   * Deque constructor with initializer list
+   * @param[in] list list of 'elemType' values
+   */
+  small_deque_t(std::initializer_list<elemType> list) : first(0), size(0), isInline(true) {
+    try {
+      for (auto& l : list)
+        PushBack(l);
+    }
+    catch (...) {
+      DestroyInline();
+      throw;
+    }
+  }
+
+  /**
+   * Copy constructor
+   * @param[in] deque const reference on deque to copy
+   */
+  small_deque_t(small_deque_t const& deque) : first(0), size(0), isInline(deque.isInline), heap(deque.heap) {
+    try {
+      if (isInline)
+        for (; size < deque.size; size++)
+          new ((void*)Slot(size)) elemType(*deque.Slot(size));
+    }
+    catch (...) {
+      DestroyInline();
+      throw;
+    }
+  }
+
+  /**
+   * Move constructor (inline elements are moved one by one, heap storage is taken as is)
+   * @param[in] deque rvalue reference on deque to move
+   */
+  small_deque_t(small_deque_t&& deque) noexcept(std::is_nothrow_move_constructible_v<elemType>) :
+    first(0), size(0), isInline(true), heap(std::move(deque.heap)) {
+    Steal(deque);
+  }
+
+  /**
+   * Copy operator= (the deque is not changed if an element constructor throws)
+   * @param[in] deque const reference on deque to copy
+   */
+  void operator=(small_deque_t const& deque) {
+    if (this == &deque)
+      return;
+
+    *this = small_deque_t(deque);
+  }
+
+  /**
+   * Move operator=
+   * @param[in] deque rvalue reference on deque to move
+   */
+  void operator=(small_deque_t&& deque) noexcept(std::is_nothrow_move_constructible_v<elemType>) {
+    if (this == &deque)
+      return;
+
+    DestroyInline();
+    heap = std::move(deque.heap);
+    Steal(deque);
+  }
+
+  /**
+   * Check are elements stored inside the object
+   * @return true if elements are stored inline, false if they are in heap storage
+   */
+  bool IsInline() const noexcept {
+    return isInline;
+  }
+
+  /**
+   * Check is deque empty method
+   * @return true if deque is empty, false otherwise
+   */
+  bool IsEmpty() const noexcept {
+    return Size() == 0;
+  }
+
+  /**
+   * Get deque size method
+   * @return number of elements in the deque
+   */
+  size_t Size() const noexcept {
+    return isInline ? size : heap.Size();
+  }
+
+  /**
+   * Get deque capacity method
+   * @return number of elements that can be stored without allocation
+   */
+  size_t Capacity() const noexcept {
+    return isInline ? inlineCapacity : heap.Capacity();
+  }
+
+  /**
+   * Operator [] (index is not checked)
+   * @param[in] index index of element
+   * @return reference on element
+   */
+  elemType& operator[](size_t index) noexcept {
+    return isInline ? *Slot(index) : heap[index];
+  }
+
+  /**
+   * Operator [] (index is not checked)
+   * @param[in] index index of element
+   * @return const reference on element
+   */
+  elemType const& operator[](size_t index) const noexcept {
+    return isInline ? *Slot(index) : heap[index];
+  }
+
+  /**
+   * Get element by index method
+   * @param[in] index index of element
+   * @return reference on element
+   * @exception "Index is out of range" if index is not less than size
+   */
+  elemType& At(size_t index) {
+    if (index >= Size())
+      throw exception("Index is out of range");
+
+    return (*this)[index];
+  }
+
+  /**
+   * Get element by index method
+   * @param[in] index index of element
+   * @return const reference on element
+   * @exception "Index is out of range" if index is not less than size
+   */
+  elemType const& At(size_t index) const {
+    if (index >= Size())
+      throw exception("Index is out of range");
+
+    return (*this)[index];
+  }
+
+  /**
+   * Method to see what first element is
+   * @returns const reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType const& PeekHead() const {
+    if (IsEmpty())
+      throw exception("Deque is empty");
+
+    return (*this)[0];
+  }
+
+  /**
+   * Method to get first element
+   * @returns reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& GetFront() {
+    if (IsEmpty())
+      throw exception("Deque is empty");
+
+    return (*this)[0];
+  }
+
+  /**
+   * Method to see what last element is
+   * @returns const reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType const& PeekTail() const {
+    if (IsEmpty())
+      throw exception("Deque is empty");
+
+    return (*this)[Size() - 1];
+  }
+
+  /**
+   * Method to get last element
+   * @returns reference on element
+   * @exception "Deque is empty" if deque is empty
+   */
+  elemType& GetBack() {
+    if (IsEmpty())
+      throw exception("Deque is empty");
+
+    return (*this)[Size() - 1];
+  }
+
+  /**
+   * Method to see what first element is without throwing on empty deque
+   * @returns pointer to first element or nullptr if deque is empty
+   */
+  elemType const* TryPeekHead() const noexcept {
+    return IsEmpty() ? nullptr : &(*this)[0];
+  }
+
+  /**
+   * Method to see what last element is without throwing on empty deque
+   * @returns pointer to last element or nullptr if deque is empty
+   */
+  elemType const* TryPeekTail() const noexcept {
+    return IsEmpty() ? nullptr : &(*this)[Size() - 1];
+  }
+
+  /**
+   * Method to construct element in place at begin of deque
+   *
+   * If the inline buffer is full, the element is constructed first, so arguments may refer to elements of the deque
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @return reference on the new element
+   */
+  template <typename... args>
+  elemType& EmplaceFront(args&&... params) {
+    if (isInline) {
+      if (size < inlineCapacity) {
+        size_t slot = (first + inlineCapacity - 1) % inlineCapacity;
+
+        new ((void*)((elemType*)storage + slot)) elemType(std::forward<args>(params)...);
+        first = slot;
+        size++;
+
+        return *Slot(0);
+      }
+
+      elemType elem(std::forward<args>(params)...);
+
+      Spill(1);
+
+      return heap.EmplaceFront(std::move(elem));
+    }
+
+    return heap.EmplaceFront(std::forward<args>(params)...);
+  }
+
+  /**
+   * Method to construct element in place at end of deque
+   *
+   * If the inline buffer is full, the element is constructed first, so arguments may refer to elements of the deque
+   * @tparam args types of constructor arguments
+   * @param[in] params arguments forwarded to the 'elemType' constructor
+   * @return reference on the new element
+   */
+  template <typename... args>
+  elemType& EmplaceBack(args&&... params) {
+    if (isInline) {
+      if (size < inlineCapacity) {
+        new ((void*)Slot(size)) elemType(std::forward<args>(params)...);
+        size++;
+
+        return *Slot(size - 1);
+      }
+
+      elemType elem(std::forward<args>(params)...);
+
+      Spill(1);
+
+      return heap.EmplaceBack(std::move(elem));
+    }
+
+    return heap.EmplaceBack(std::forward<args>(params)...);
+  }
+
+  /**
+   * Method put element to begin of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushFront(elemType const& elem) {
+    EmplaceFront(elem);
+  }
+
+  /**
+   * Method put element to begin of deque (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushFront(elemType&& elem) {
+    EmplaceFront(std::move(elem));
+  }
+
+  /**
+   * Method put element to end of deque (copy semantics)
+   * @param[in] elem const reference on element
+   */
+  void PushBack(elemType const& elem) {
+    EmplaceBack(elem);
+  }
+
+  /**
+   * Method put element to end of deque (move semantics)
+   * @param[in] elem rvalue reference on element
+   */
+  void PushBack(elemType&& elem) {
+    EmplaceBack(std::move(elem));
+  }
+
+  /**
+   * Method to remove first element from deque
+   * @exception "Deque is empty" if deque is empty
+   */
+  void PopFront() {
+    if (!isInline) {
+      heap.PopFront();
+      return;
+    }
+
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    Slot(0)->~elemType();
+    first = (first + 1) % inlineCapacity;
+    size--;
+  }
+
+  /**
+   * Method to remove last element from deque
+   * @exception "Deque is empty" if deque is empty
+   */
+  void PopBack() {
+    if (!isInline) {
+      heap.PopBack();
+      return;
+    }
+
+    if (size == 0)
+      throw exception("Deque is empty");
+
+    Slot(size - 1)->~elemType();
+    size--;
+  }
+
+  /**
+   * Method to take first element from deque without throwing on empty deque
+   * @returns moved first element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopFront() {
+    if (IsEmpty())
+      return std::nullopt;
+
+    std::optional<elemType> result(std::move((*this)[0]));
+
+    PopFront();
+
+    return result;
+  }
+
+  /**
+   * Method to take last element from deque without throwing on empty deque
+   * @returns moved last element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopBack() {
+    if (IsEmpty())
+      return std::nullopt;
+
+    std::optional<elemType> result(std::move((*this)[Size() - 1]));
+
+    PopBack();
+
+    return result;
+  }
+
+  /**
+   * Method for adding elements of another deque to the end of the current one (copy semantics)
+   * @param[in] deque const reference on other deque
+   * @returns refernece on current deque
+   */
+  small_deque_t& AddOtherDeque(small_deque_t const& deque) {
+    size_t count = deque.Size();
+
+    if (isInline && size + count > inlineCapacity)
+      Spill(count);
+
+    for (size_t i = 0; i < count; i++)
+      PushBack(deque[i]);
+
+    return *this;
+  }
+
+  /**
+   * Method for adding elements of another deque to the end of the current one (move semantics)
+   *
+   * If the current deque is empty and other one has overflowed, its heap storage is taken as is;
+   * otherwise elements are moved one by one
+   * @param[in] deque rvalue reference on other deque
+   * @returns refernece on current deque
+   */
+  small_deque_t& AddOtherDeque(small_deque_t&& deque) {
+    if (this == &deque)
+      return *this;
+
+    if (!deque.isInline && (isInline ? size == 0 : heap.IsEmpty())) {
+      heap.AddOtherDeque(std::move(deque.heap));
+      isInline = false;
+    }
+    else if (!isInline && !deque.isInline)
+      heap.AddOtherDeque(std::move(deque.heap));
+    else {
+      size_t count = deque.Size();
+
+      if (isInline && size + count > inlineCapacity)
+        Spill(count);
+
+      for (size_t i = 0; i < count; i++)
+        PushBack(std::move(deque[i]));
+
+      deque.Clear();
+    }
+
+    return *this;
+  }
+
+  /**
+   * Method to return elements inside the object if they fit, or to free unused heap storage otherwise
+   */
+  void ShrinkToFit() {
+    if (isInline)
+      return;
+
+    size_t count = heap.Size();
+
+    if (count > inlineCapacity) {
+      heap.ShrinkToFit();
+      return;
+    }
+
+    try {
+      for (; size < count; size++)
+        new ((void*)Slot(size)) elemType(std::move_if_noexcept(heap[size]));
+    }
+    catch (...) {
+      DestroyInline();
+      throw;
+    }
+
+    heap.Clear();
+    heap.ShrinkToFit();
+    isInline = true;
+  }
+
+  /**
+   * Write elements to stream through a buffer without flushing the stream
+   * @param[in] stream output stream
+   * @param[in] separator string written after every element
+   * @return reference to stream
+   */
+  std::ostream& WriteTo(std::ostream& stream, std::string_view separator = " ") const {
+    if (!isInline)
+      return heap.WriteTo(stream, separator);
+
+    stream_writer_t writer(stream);
+
+    for (size_t i = 0; i < size; i++) {
+      writer.Put(*Slot(i));
+      writer.Write(separator);
+    }
+
+    writer.Flush();
+
+    return stream;
+  }
+
+  /**
+   * Clear deque (heap storage is kept for further use)
+   */
+  void Clear(void) {
+    if (isInline)
+      DestroyInline();
+    else
+      heap.Clear();
+  }
+
+  /**
+   * Deque destructor
+   */
+  ~small_deque_t() {
+    DestroyInline();
+  }
+};
+
+/**
+ * Operator<< for small deque (elements are separated by spaces and followed by a new line, the stream is not flushed)
+ * @tparam type type of deque elements
+ * @tparam inlineCapacity number of elements stored inside the object
+ * @tparam memoryAllocator the allocator used after overflow
+ * @param[in] stream output stream
+ * @param[in] deque deque to output
+ * @return reference to stream
+ */
+template <typename type, size_t inlineCapacity, typename memoryAllocator>
+std::ostream& operator<<(std::ostream& stream, small_deque_t<type, inlineCapacity, memoryAllocator> const& deque) {
+  return deque.WriteTo(stream) << '\n';
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <exception>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+using std::exception;
+
+/**
+ * Version of the binary snapshot format written by Serialize
+ */
+constexpr uint32_t snapshotVersion = 1;
+
+/**
+ * Size of the buffer used to read snapshot payload
+ */
+constexpr size_t snapshotChunkSize = 16384;
+
+/**
+ * @brief Binary snapshot header
+ *
+ * Snapshot is the header followed by 'count' raw elements of 'elemSize' bytes in native byte order;
+ * the header size keeps the payload aligned for elements with alignment up to 32 bytes when the file is mapped
+ */
+struct snapshot_header_t {
+  char magic[8];        ///< "DEQUESNP" signature
+  uint32_t version;     ///< format version (snapshotVersion)
+  uint32_t elemSize;    ///< size of one element in bytes
+  uint64_t count;       ///< number of elements
+  uint64_t reserved;    ///< reserved, always 0
+};
+
+static_assert(sizeof(snapshot_header_t) == 32, "Snapshot header must not have padding");
+
+/**
+ * Signature of snapshot files
+ */
+constexpr char snapshotMagic[8] = { 'D', 'E', 'Q', 'U', 'E', 'S', 'N', 'P' };
+
+/**
+ * Build snapshot header
+ * @param[in] elemSize size of one element in bytes
+ * @param[in] count number of elements
+ * @return header
+ */
+inline snapshot_header_t MakeSnapshotHeader(size_t elemSize, uint64_t count) noexcept {
+  snapshot_header_t header;
+
+  std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+  header.version = snapshotVersion;
+  header.elemSize = (uint32_t)elemSize;
+  header.count = count;
+  header.reserved = 0;
+
+  return header;
+}
+
+/**
+ * Check snapshot header
+ * @param[in] header header to check
+ * @param[in] elemSize expected size of one element in bytes
+ * @exception "Invalid snapshot" if the signature is wrong
+ * @exception "Unsupported snapshot version" if the version is not snapshotVersion
+ * @exception "Snapshot element size mismatch" if elements of snapshot have other size
+ */
+inline void CheckSnapshotHeader(snapshot_header_t const& header, size_t elemSize) {
+  if (std::memcmp(header.magic, snapshotMagic, sizeof(snapshotMagic)) != 0)
+    throw exception("Invalid snapshot");
+
+  if (header.version != snapshotVersion)
+    throw exception("Unsupported snapshot version");
+
+  if (header.elemSize != elemSize)
+    throw exception("Snapshot element size mismatch");
+}
+
+/**
+ * Read and check snapshot header from stream
+ * @param[in] stream input stream
+ * @param[in] elemSize expected size of one element in bytes
+ * @return number of elements in snapshot
+ * @exception "Snapshot is truncated" if the stream ends before the header does
+ * @see CheckSnapshotHeader
+ */
+inline uint64_t ReadSnapshotHeader(std::istream& stream, size_t elemSize) {
+  snapshot_header_t header;
+
+  if (!stream.read((char*)&header, sizeof(header)))
+    throw exception("Snapshot is truncated");
+
+  CheckSnapshotHeader(header, elemSize);
+
+  return header.count;
+}
+
+/**
+ * Read snapshot payload from stream by chunks
+ * @tparam elemType type of stored elements (trivially copyable)
+ * @tparam func type of function called as func(from, to) with pointers to the read elements
+ * @param[in] stream input stream positioned after the header
+ * @param[in] count number of elements to read
+ * @param[in] f function to call for every chunk
+ * @exception "Snapshot is truncated" if the stream ends before 'count' elements are read
+ */
+template <typename elemType, typename func>
+void ReadSnapshotPayload(std::istream& stream, uint64_t count, func&& f) {
+  static_assert(sizeof(elemType) <= snapshotChunkSize, "Element is too large for snapshot buffer");
+
+  alignas(elemType) char buffer[snapshotChunkSize];
+  constexpr size_t chunk = snapshotChunkSize / sizeof(elemType);
+
+  while (count) {
+    size_t n = (size_t)std::min<uint64_t>(count, chunk);
+
+    if (!stream.read(buffer, (std::streamsize)(n * sizeof(elemType))))
+      throw exception("Snapshot is truncated");
+
+    f((elemType const*)buffer, (elemType const*)buffer + n);
+    count -= n;
+  }
+}
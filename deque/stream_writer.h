@@ -0,0 +1,105 @@
+#pragma once
+
+#include <ostream>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+#include <cstddef>
+
+/**
+ * Size of the buffer used by stream_writer_t
+ */
+constexpr size_t streamBufferSize = 16384;
+
+/**
+ * Concept of types formatted with std::to_chars (arithmetic types except bool and character types)
+ */
+template <typename type>
+concept chars_formattable = std::is_arithmetic_v<type> && !std::is_same_v<type, bool> && !std::is_same_v<type, char> &&
+  !std::is_same_v<type, signed char> && !std::is_same_v<type, unsigned char> && requires(char* p, type value) {
+    std::to_chars(p, p, value);
+  };
+
+/**
+ * @brief Buffered stream writer
+ *
+ * Collects formatted elements in a buffer and passes it to the stream in large chunks;
+ * the stream is never flushed, written data is passed to it at the latest by the destructor
+ */
+class stream_writer_t {
+private:
+  static constexpr size_t maxNumberLength = 64;   ///< upper bound of the length of a number formatted with std::to_chars
+
+  std::ostream& stream;                  ///< stream to write to
+  char buffer[streamBufferSize];         ///< collected data
+  size_t used;                           ///< number of used bytes of the buffer
+public:
+  /**
+   * Constructor from stream
+   * @param[in] stream output stream
+   */
+  explicit stream_writer_t(std::ostream& stream) : stream(stream), used(0) {}
+
+  stream_writer_t(stream_writer_t const&) = delete;
+  stream_writer_t& operator=(stream_writer_t const&) = delete;
+
+  /**
+   * Pass collected data to the stream
+   */
+  void Flush() {
+    if (used)
+      stream.write(buffer, (std::streamsize)used);
+
+    used = 0;
+  }
+
+  /**
+   * Write string
+   * @param[in] str string to write
+   */
+  void Write(std::string_view str) {
+    if (used + str.size() > streamBufferSize) {
+      Flush();
+
+      if (str.size() > streamBufferSize) {
+        stream.write(str.data(), (std::streamsize)str.size());
+        return;
+      }
+    }
+
+    str.copy(buffer + used, str.size());
+    used += str.size();
+  }
+
+  /**
+   * Write value (arithmetic values are formatted with std::to_chars, others with operator<< of the stream)
+   * @tparam type type of value
+   * @param[in] value value to write
+   */
+  template <typename type>
+  void Put(type const& value) {
+    if constexpr (chars_formattable<type>) {
+      if (used + maxNumberLength > streamBufferSize)
+        Flush();
+
+      used = (size_t)(std::to_chars(buffer + used, buffer + streamBufferSize, value).ptr - buffer);
+    }
+    else if constexpr (std::is_convertible_v<type const&, std::string_view>)
+      Write(std::string_view(value));
+    else {
+      Flush();
+      stream << value;
+    }
+  }
+
+  /**
+   * Stream writer destructor (passes the rest of data to the stream, errors are left in the stream state)
+   */
+  ~stream_writer_t() {
+    try {
+      Flush();
+    }
+    catch (...) {
+    }
+  }
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <new>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include "allocator.h"
+
+/**
+ * @brief Work-stealing deque class
+ *
+ * Chase-Lev deque on a growable ring buffer: the owner thread pushes and pops at the back,
+ * other threads steal from the front with a single CAS. Owner operations use plain loads and stores
+ * with fences, the only CAS on the owner side happens when it races for the last element.
+ * Buffers replaced by growth are kept until destruction because thieves may still read them
+ * @tparam elemType type of stored elements (trivially copyable, e.g. pointer to task)
+ * @tparam memoryAllocator the allocator to be used (called only by the owner thread; buffers double in size,
+ * so fixed slot allocators such as pool_allocator_t are rejected)
+ * @see deque_allocator
+ */
+template <typename elemType, deque_allocator memoryAllocator = simple_allocator_t>
+class work_stealing_deque_t : private allocator_holder_t<memoryAllocator> {
+private:
+  static_assert(std::is_trivially_copyable_v<elemType>, "Work-stealing deque elements must be trivially copyable");
+  static_assert(!fixed_slot_allocator<memoryAllocator>, "Work-stealing deque buffers grow, a fixed slot allocator cannot serve them");
+
+  using holder_t = allocator_holder_t<memoryAllocator>;
+  using holder_t::Allocator;
+
+  /**
+   * @brief Ring buffer struct
+   *
+   * Buffer of 'capacity' slots (power of two), slot of index i is i & (capacity - 1)
+   */
+  struct alignas(std::max_align_t) buffer_t {
+    int64_t capacity;                 ///< number of slots
+    buffer_t* retired;                ///< previous buffer kept until destruction (nullptr if none)
+    std::atomic<elemType>* slots;     ///< slots (right after the header)
+
+    /**
+     * Get slot by index
+     * @param[in] index element index
+     * @return reference on slot
+     */
+    std::atomic<elemType>& operator[](int64_t index) noexcept {
+      return slots[index & (capacity - 1)];
+    }
+  };
+
+  static constexpr size_t cacheLineSize = 64;   ///< assumed size of a cache line
+  static constexpr size_t slotAlignment = alignof(std::atomic<elemType>);                                    ///< alignment of slots
+  static constexpr size_t slotsOffset = (sizeof(buffer_t) + slotAlignment - 1) / slotAlignment * slotAlignment;  ///< offset of slots in a buffer
+  static constexpr size_t bufferAlignment = std::max(alignof(buffer_t), slotAlignment);                          ///< alignment of buffers
+
+  alignas(cacheLineSize) std::atomic<int64_t> top;          ///< index of the first element (changed by thieves)
+  alignas(cacheLineSize) std::atomic<int64_t> bottom;       ///< index after the last element (changed by owner)
+  alignas(cacheLineSize) std::atomic<buffer_t*> buffer;     ///< current ring buffer
+
+  /**
+   * Allocate ring buffer
+   * @param[in] capacity number of slots (power of two)
+   * @return pointer to buffer
+   */
+  buffer_t* CreateBuffer(int64_t capacity) {
+    buffer_t* buf = (buffer_t*)AllocAligned<bufferAlignment>(Allocator(), slotsOffset + (size_t)capacity * sizeof(std::atomic<elemType>));
+
+    buf->capacity = capacity;
+    buf->retired = nullptr;
+    buf->slots = (std::atomic<elemType>*)((char*)buf + slotsOffset);
+
+    for (int64_t i = 0; i < capacity; i++)
+      new ((void*)&buf->slots[i]) std::atomic<elemType>();
+
+    return buf;
+  }
+
+  /**
+   * Double the buffer (owner only)
+   * @param[in] buf current buffer
+   * @param[in] t index of the first element
+   * @param[in] b index after the last element
+   * @return pointer to new buffer
+   */
+  buffer_t* Grow(buffer_t* buf, int64_t t, int64_t b) {
+    buffer_t* newBuf = CreateBuffer(buf->capacity * 2);
+
+    for (int64_t i = t; i < b; i++)
+      (*newBuf)[i].store((*buf)[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    newBuf->retired = buf;
+    buffer.store(newBuf, std::memory_order_release);
+
+    return newBuf;
+  }
+public:
+  /**
+   * Work-stealing deque constructor
+   * @param[in] capacity initial number of slots (rounded up to a power of two)
+   */
+  explicit work_stealing_deque_t(size_t capacity = 64) : top(0), bottom(0) {
+    int64_t cap = 2;
+
+    while ((size_t)cap < capacity)
+      cap *= 2;
+
+    buffer.store(CreateBuffer(cap), std::memory_order_relaxed);
+  }
+
+  work_stealing_deque_t(work_stealing_deque_t const&) = delete;
+  work_stealing_deque_t& operator=(work_stealing_deque_t const&) = delete;
+
+  /**
+   * Get deque size method
+   * @return number of elements in the deque (a snapshot that may be outdated at once)
+   */
+  size_t Size() const noexcept {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    return b > t ? (size_t)(b - t) : 0;
+  }
+
+  /**
+   * Check is deque empty method
+   * @return true if deque is empty, false otherwise (a snapshot that may be outdated at once)
+   */
+  bool IsEmpty() const noexcept {
+    return Size() == 0;
+  }
+
+  /**
+   * Method put element to end of deque (owner only)
+   * @param[in] elem element to put
+   */
+  void PushBack(elemType elem) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    buffer_t* buf = buffer.load(std::memory_order_relaxed);
+
+    if (b - t > buf->capacity - 1)
+      buf = Grow(buf, t, b);
+
+    (*buf)[b].store(elem, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Method to take last element from deque (owner only)
+   * @returns last element or std::nullopt if deque is empty
+   */
+  std::optional<elemType> TryPopBack() noexcept {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    buffer_t* buf = buffer.load(std::memory_order_relaxed);
+
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+
+    elemType elem = (*buf)[b].load(std::memory_order_relaxed);
+
+    if (t == b) {
+      bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+
+      bottom.store(b + 1, std::memory_order_relaxed);
+
+      if (!won)
+        return std::nullopt;
+    }
+
+    return elem;
+  }
+
+  /**
+   * Method to steal first element from deque (any thread)
+   * @returns first element or std::nullopt if deque is empty or other thread took the element first
+   */
+  std::optional<elemType> Steal() noexcept {
+    int64_t t = top.load(std::memory_order_acquire);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    int64_t b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+      return std::nullopt;
+
+    buffer_t* buf = buffer.load(std::memory_order_acquire);
+    elemType elem = (*buf)[t].load(std::memory_order_relaxed);
+
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return std::nullopt;
+
+    return elem;
+  }
+
+  /**
+   * Deque destructor (must not run concurrently with other methods)
+   */
+  ~work_stealing_deque_t() {
+    buffer_t* buf = buffer.load(std::memory_order_relaxed);
+
+    while (buf) {
+      buffer_t* retired = buf->retired;
+
+      DeallocAligned<bufferAlignment>(Allocator(), (void*)buf);
+      buf = retired;
+    }
+  }
+};